@@ -0,0 +1,24 @@
+/**
+ * Ambient light compensation. The light sensor on AMBIENT_ADC_CHANNEL is
+ * converted continuously by the ADC's DMA engine and averaged by a
+ * background task on core 0, so the loop never waits on analogRead(). The
+ * smoothed reading maps to a brightness scale between AMBIENT_MIN_SCALE in
+ * the dark and unity in daylight, which the output stage applies together
+ * with the power limiter.
+ */
+
+#ifndef AMBIENT_H
+#define AMBIENT_H
+
+#include <stdint.h>
+
+// Starts continuous conversion and the filter task.
+void ambientBegin();
+
+// Current brightness scale, 256 = unity. Lock-free; 256 when disabled.
+uint16_t ambientBrightness();
+
+// Prints the filtered reading and the scale.
+void reportAmbient();
+
+#endif
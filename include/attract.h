@@ -0,0 +1,29 @@
+/**
+ * Idle/attract mode: a subtle breathing glow with per-step noise shimmer while
+ * nobody is on the stairs. Everything comes from small fixed-point lookup
+ * tables, it renders at ATTRACT_FRAME_DELAY instead of the full frame rate,
+ * and it fades out under the walker animation when a sensor triggers.
+ */
+
+#ifndef ATTRACT_H
+#define ATTRACT_H
+
+#include <stdint.h>
+
+// Tells the attract mode whether the staircase is idle; starts the fade in or hand-off.
+void attractSetIdle(bool idle, uint32_t now);
+
+// True while the attract glow is visible or fading.
+bool attractActive(uint32_t now);
+
+// Blends the ambient glow into levels[1..NUM_OF_STEPS] (highest wins).
+void attractLevels(uint32_t now, uint8_t *levels);
+
+// Counts a whole frame rendered while the glow is active, from its micros() start.
+void attractFrameDone(uint32_t start);
+
+// Prints the cost of the frames rendered while the glow is active, from evaluating the
+// effects to output and recording, the glow blend's part of it, and their share of CPU.
+void reportAttract();
+
+#endif
@@ -0,0 +1,25 @@
+/**
+ * Cold boot output. Before Serial or any other subsystem starts, the DMX
+ * port is brought up and a blackout frame is sent, so the first known frame
+ * does not wait on flash. The boot scene persisted in NVS follows as a second
+ * frame, cut in without a fade; none set leaves the blackout. This keeps
+ * fixtures from sitting in their own power-on state until the first trigger.
+ */
+
+#ifndef BOOT_H
+#define BOOT_H
+
+#include <stdint.h>
+#include "warm_start.h"
+
+// Starts the DMX output and sends the blackout and boot scene frames, or the
+// restored frame after a warm restart. First call in setup().
+void bootBegin(const WarmState *resume);
+
+// Persists the scene shown at the next boot; NO_SCENE for blackout.
+void bootSetScene(uint8_t scene);
+
+// Prints the boot scene and the time from reset to the first frame and to the boot scene.
+void reportBoot();
+
+#endif
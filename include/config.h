@@ -0,0 +1,119 @@
+/**
+ * Build-time configuration for the staircase. Hardware and firmware options
+ * live here; the look (steps, timings, patch, colours) comes from the show
+ * header generated by tools/showc.py.
+ */
+
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include "show.h"
+
+#define DEBUG             1
+
+#define SENSOR1           25
+#define SENSOR2           26
+
+// Presence inputs as {GPIO, role, index}, see sensors.h. Landings and steps
+// are added here, e.g. {27, SENSOR_LANDING, 10}.
+#define SENSOR_BANK \
+  {SENSOR1, SENSOR_END, WAVE_UP}, \
+  {SENSOR2, SENSOR_END, WAVE_DOWN}
+
+#define SENSOR_SAMPLE_INTERVAL     1000      // us between input samples, timer driven
+#define SENSOR_FILTER_WINDOW       8         // samples voted over (M)
+#define SENSOR_FILTER_VOTES        6         // samples that must agree to change level (N of M)
+#define SENSOR_EVENT_QUEUE         16        // filtered edges buffered between polls
+
+#define SENSOR_STUCK_HIGH_TIME     60000     // a sensor held high this long is ignored
+#define SENSOR_STUCK_LOW_TIME      3600000   // no edge for this long...
+#define SENSOR_STUCK_LOW_TRIGGERS  20        // ...while the other end triggered this often
+#define SENSOR_RECOVERY_TRIGGERS   3         // clean triggers a flagged sensor needs to count again
+#define SENSOR_RECOVERY_GAP        2000      // ms of steady level before an edge counts as clean
+
+
+// Debounce, hold, step and clear-step timing are runtime-tunable, see runtime_config.h.
+#define CONFIG_DEBOUNCE_MAX 10000   // longest debounce the runtime config accepts, ms
+#define STEP_FADE_IN      show::fadeInDelay
+#define STEP_FADE_OUT     show::fadeOutDelay
+#define WAVE_EDGE_WIDTH   show::edgeWidth
+#define WAVE_TAIL_FLOOR   show::tailFloor
+#define WAVE_TAIL_HALF_LIFE show::tailHalfLife
+#define FRAME_UPDATE_DELAY show::frameDelay
+
+#define NUM_OF_STEPS      show::numSteps   // steps patched in the show; the runtime config may use fewer
+
+#define STEP_ON_LEVEL     show::onLevel
+
+#define MODE_WAVE         0   // whole staircase follows the up/down wave
+#define MODE_TRAIL        1   // only a window around each estimated walker is lit
+#define STAIR_MODE        MODE_WAVE
+
+#define TRAIL_MAX_WALKERS   4
+#define TRAIL_AHEAD         2       // steps lit ahead of a walker
+#define TRAIL_BEHIND        1       // steps lit behind a walker
+#define TRAIL_MIN_TRAVERSAL 2000    // plausible time to walk the whole staircase
+#define TRAIL_MAX_TRAVERSAL 60000
+
+#define ATTRACT_ENABLE        1
+#define ATTRACT_FRAME_DELAY   50     // render period while nothing else is moving
+#define ATTRACT_FADE          2000   // attract fade in after the stairs go idle
+#define ATTRACT_HANDOFF       600    // attract fade out when a walker triggers
+#define ATTRACT_FLOOR         6      // ambient base level
+#define ATTRACT_BREATH_DEPTH  18     // breathing swing on top of the floor
+#define ATTRACT_BREATH_PERIOD 6000
+#define ATTRACT_SHIMMER_DEPTH 6      // +/- noise shimmer
+
+#define CROWD_ENABLE          1
+#define CROWD_TIME_CONSTANT   60000   // ms; the rate reads as triggers per this time
+#define CROWD_ENTER_RATE      20      // steady on above this many triggers per time constant
+#define CROWD_EXIT_RATE       8       // back to walker animations below this
+#define CROWD_CHECK_INTERVAL  1000
+
+#define AMBIENT_ENABLE       1
+#define AMBIENT_ADC_CHANNEL  ADC1_CHANNEL_6   // GPIO34
+#define AMBIENT_SAMPLE_RATE  20000   // Hz, the ESP32's lowest DMA conversion rate
+#define AMBIENT_SMOOTHING    6       // filter time constant, 2^n DMA frames (~0.8 s)
+#define AMBIENT_DARK         200     // reading at or below which steps run at AMBIENT_MIN_SCALE
+#define AMBIENT_BRIGHT       3000    // reading at or above which steps run at full level
+#define AMBIENT_MIN_SCALE    90      // night brightness, 256 = unity
+#define AMBIENT_HYSTERESIS   6       // scale change needed before the output rescales
+
+#define ENERGY_CHECKPOINT_INTERVAL 600000   // ms between NVS checkpoints
+#define ENERGY_RING_SLOTS          4        // NVS keys rotated through by checkpoints
+
+#define RECORD_ENABLE            1       // record every frame sent into the flash ring, see recorder.h
+#define RECORD_KEYFRAME_INTERVAL 10000   // ms; seek granularity of a replay
+#define RECORD_FLUSH_INTERVAL    60000   // ms a partly filled block may wait in RAM
+#define RECORD_ERASE_AHEAD       32      // sectors erased ahead of the write position
+#define RECORD_ERASE_INTERVAL    1000    // ms between erases, which stall both cores
+
+#define WARM_START_ENABLE  1       // resume from the RTC snapshot after a watchdog/brownout reset
+#define WARM_MAX_RESTORES  3       // consecutive warm restarts before falling back to a cold boot
+#define WARM_STABLE_TIME   10000   // ms of uptime after which a restart counts as a fresh one
+
+#ifndef HEAP_GUARD
+#define HEAP_GUARD        0   // count heap allocations after setup(), see stats.h
+#endif
+#ifndef HEAP_GUARD_TRAP
+#define HEAP_GUARD_TRAP   0   // abort on an allocation from the loop task
+#endif
+#define STATS_MAX_TASKS   6
+
+#define DMX_ENGINE_UART   0   // break by baud switch, slots through the UART FIFO
+#define DMX_ENGINE_RMT    1   // whole frame encoded as RMT items, sent by the peripheral
+#define DMX_ENGINE_I2S    2   // up to 8 universes in parallel from I2S1, the show on line 0
+#ifndef DMX_ENGINE
+#define DMX_ENGINE        DMX_ENGINE_UART
+#endif
+#define DMX_PARALLEL_PINS 17   // I2S engine line pins, line 0 first; 17 is the shield's TX
+#define DMX_INPUT_ENABLE  0    // receive a console universe alongside the output
+#define DMX_INPUT_PIN     4    // its own RS-485 receiver; the shield's transceiver is half duplex
+
+#define SERIAL_BAUD       115200  // console; 'record dump' streams ~9 KB per block, 40 s for four at 9600
+#define SERIAL_TX_BUFFER  1024    // bytes queued for the console before a print waits
+#define COMMAND_MAX_LINE  160   // longest serial command line
+
+#define USE_FRAME_TABLES  1   // play waves from precomputed flash tables instead of evaluating them
+
+#endif
@@ -0,0 +1,25 @@
+/**
+ * Crowd mode. End-sensor triggers feed an exponentially decayed count with
+ * time constant CROWD_TIME_CONSTANT, which settles at the number of triggers
+ * per time constant. Above CROWD_ENTER_RATE the staircase holds steady at full
+ * level instead of restarting waves for every walker; it drops back to the
+ * walker animations once the rate falls below CROWD_EXIT_RATE.
+ */
+
+#ifndef CROWD_H
+#define CROWD_H
+
+#include <stdint.h>
+
+// Counts one end-sensor trigger.
+void crowdTrigger(uint32_t now);
+
+// Re-evaluates the rate every CROWD_CHECK_INTERVAL. Returns crowdActive().
+bool crowdUpdate(uint32_t now);
+
+bool crowdActive();
+
+// Prints the current rate estimate and state.
+void reportCrowd();
+
+#endif
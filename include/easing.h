@@ -0,0 +1,40 @@
+/**
+ * Easing curves shared by the effect VM and the attract mode, as 256-entry
+ * lookup tables built at compile time: input 0..255, output 0..255.
+ */
+
+#ifndef EASING_H
+#define EASING_H
+
+#include <stdint.h>
+#include <array>
+
+enum EaseCurve : uint8_t {
+  CURVE_LINEAR,
+  CURVE_QUAD_IN,
+  CURVE_QUAD_OUT,
+  CURVE_SMOOTH,   // smoothstep
+  CURVE_BELL,     // 0 -> 255 -> 0 over the input range, smoothstep each way
+  NUM_EASE_CURVES
+};
+
+constexpr uint8_t easeValue(uint8_t curve, uint32_t x) {
+  return curve == CURVE_QUAD_IN  ? x * x / 255
+       : curve == CURVE_QUAD_OUT ? 255 - (255 - x) * (255 - x) / 255
+       : curve == CURVE_SMOOTH   ? x * x * (765 - 2 * x) / 65025
+       : curve == CURVE_BELL     ? easeValue(CURVE_SMOOTH, x < 128 ? x * 2 : (255 - x) * 2 + 1)
+       : x;
+}
+
+constexpr std::array<std::array<uint8_t, 256>, NUM_EASE_CURVES> buildEaseTables() {
+  std::array<std::array<uint8_t, 256>, NUM_EASE_CURVES> tables{};
+  for (uint8_t curve = 0; curve < NUM_EASE_CURVES; curve++) {
+    for (uint32_t x = 0; x < 256; x++) { tables[curve][x] = easeValue(curve, x); }
+  }
+  return tables;
+}
+
+// Inline, so every user shares the one copy in flash.
+inline constexpr auto easeTables = buildEaseTables();
+
+#endif
@@ -0,0 +1,77 @@
+/**
+ * Small register-based bytecode VM for user-defined step effects.
+ *
+ * A program runs once per step each frame over the rendered step levels, so
+ * custom looks can be loaded from flash or over serial without a reflash.
+ * Every instruction is four bytes: [op][d][a][b], computing d = a <op> b on
+ * eight int32 registers. Arithmetic wraps like uint32_t instead of
+ * overflowing, since programs arrive over serial and must not reach
+ * undefined behaviour. Only forward skips exist, so a program always
+ * finishes; VM_FRAME_BUDGET additionally caps the work done in one frame.
+ * Programs are validated once at load time and the interpreter does no
+ * checks while running.
+ */
+
+#ifndef EFFECT_VM_H
+#define EFFECT_VM_H
+
+#include <stdint.h>
+#include "easing.h"
+
+#define VM_REGISTERS     8
+#define VM_MAX_PROGRAM   64     // instructions
+#define VM_FRAME_BUDGET  2048   // instructions per frame over all steps
+
+enum VmOp : uint8_t {
+  VM_END,     // stop, keep the step's level
+  VM_LDI,     // d = (int16)(a | b << 8)
+  VM_MOV,     // d = a
+  VM_STEP,    // d = step number, 1..NUM_OF_STEPS
+  VM_COUNT,   // d = NUM_OF_STEPS
+  VM_TIME,    // d = ms since the program was loaded
+  VM_LEVEL,   // d = level rendered for this step by the wave
+  VM_ADD,     // d = a + b
+  VM_SUB,     // d = a - b
+  VM_MUL,     // d = a * b
+  VM_DIV,     // d = a / b (0 when b is 0, -a when b is -1)
+  VM_AND,     // d = a & b
+  VM_SHR,     // d = a >> b
+  VM_MIN,     // d = min(a, b)
+  VM_MAX,     // d = max(a, b)
+  VM_EASE,    // d = EaseCurve b (easing.h) applied to a (clamped to 0..255)
+  VM_BLEND,   // d = a + (b - a) * d / 255, d clamped to 0..255
+  VM_SKIPLT,  // skip the next d instructions if a < b
+  VM_OUT,     // set the step's level to d (clamped to 0..255) and stop
+  VM_NUM_OPS
+};
+
+struct VmInstr {
+  uint8_t op;
+  uint8_t d;
+  uint8_t a;
+  uint8_t b;
+};
+
+struct VmProgram {
+  const char *name;
+  const VmInstr *code;
+  uint8_t length;
+};
+
+extern const VmProgram vmBuiltins[];
+extern const uint8_t vmNumBuiltins;
+
+// Validates and installs a program. Returns false and leaves the VM unchanged if invalid.
+bool vmLoad(const VmInstr *code, uint8_t length);
+// Loads a builtin by name, or a program given as hex bytes (8 digits per instruction).
+bool vmLoadText(const char *text);
+void vmUnload();
+bool vmActive();
+
+// Runs the program over levels[1..NUM_OF_STEPS]. Returns the instructions executed.
+uint32_t vmRun(uint8_t *levels);
+
+// Prints instructions per second for the loaded program (or the first builtin).
+void vmBenchmark();
+
+#endif
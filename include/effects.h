@@ -0,0 +1,174 @@
+/**
+ * Staircase effects as pure functions of (trigger, elapsed time).
+ *
+ * Nothing in here keeps state between calls: the level of any step can be
+ * evaluated for any timestamp. The renderer only does work at frame time, a
+ * late frame lands directly on the right picture instead of catching up one
+ * step at a time, and a simulator can seek anywhere inside a sequence.
+ *
+ * The step count and timings come from the RuntimeConfig passed in, so the
+ * same functions render the compiled show's frame tables at compile time and
+ * a site-tuned config at run time.
+ */
+
+#ifndef EFFECTS_H
+#define EFFECTS_H
+
+#include <stdint.h>
+#include "config.h"
+#include "runtime_config.h"
+
+#define WAVE_NONE 0
+#define WAVE_UP   1   // lights step 1 first, clears the top step first
+#define WAVE_DOWN 2   // lights the top step first, clears step 1 first
+
+enum WavePhase : uint8_t {
+  PHASE_IDLE,
+  PHASE_FILLING,
+  PHASE_HOLDING,
+  PHASE_CLEARING,
+  PHASE_DONE
+};
+
+struct WaveTrigger {
+  uint8_t  direction;    // WAVE_NONE, WAVE_UP or WAVE_DOWN
+  uint32_t startMillis;  // millis() of the trigger that started the wave
+  uint32_t holdElapsed;  // ms after startMillis of the latest re-trigger
+};
+
+// Time from the trigger until the last step starts lighting.
+constexpr uint32_t waveFillTime(const RuntimeConfig &c) {
+  return (uint32_t)(c.numSteps - 1) * c.stepDelay;
+}
+
+// Time the anti-aliased wavefront ramp takes to pass one step.
+constexpr uint32_t waveEdgeTime(const RuntimeConfig &c) {
+  return ((uint32_t)WAVE_EDGE_WIDTH * c.stepDelay + 255) / 256;
+}
+
+// Time a step takes from starting to light to full level: the longer of its fade-in and the edge.
+constexpr uint32_t waveRampTime(const RuntimeConfig &c) {
+  return STEP_FADE_IN > waveEdgeTime(c) ? STEP_FADE_IN : waveEdgeTime(c);
+}
+
+// Time from the trigger until every step is at full level.
+constexpr uint32_t waveLitTime(const RuntimeConfig &c) {
+  return waveFillTime(c) + waveRampTime(c);
+}
+
+// Time from the trigger until the first step is cleared again.
+constexpr uint32_t waveClearStart(const RuntimeConfig &c, const WaveTrigger &t) {
+  return (t.holdElapsed > waveFillTime(c) ? t.holdElapsed : waveFillTime(c)) + c.holdDelay;
+}
+
+// Time from the trigger until the last step has faded out.
+constexpr uint32_t waveEndTime(const RuntimeConfig &c, const WaveTrigger &t) {
+  return waveClearStart(c, t) + (uint32_t)(c.numSteps - 1) * c.clearStepDelay + STEP_FADE_OUT;
+}
+
+// Number of steps the wave has cleared again, in reverse lighting order.
+constexpr uint8_t waveClearedCount(const RuntimeConfig &c, const WaveTrigger &t, uint32_t elapsed) {
+  return elapsed < waveClearStart(c, t) ? 0
+       : elapsed >= waveClearStart(c, t) + (uint32_t)(c.numSteps - 1) * c.clearStepDelay ? c.numSteps
+       : (elapsed - waveClearStart(c, t)) / c.clearStepDelay + 1;
+}
+
+// Position of a step (1..numSteps) in the wave's lighting order.
+constexpr uint8_t waveOrder(const RuntimeConfig &c, uint8_t direction, uint8_t step) {
+  return direction == WAVE_DOWN ? c.numSteps - step : step - 1;
+}
+
+// Step (1..numSteps) at a position in the wave's lighting order.
+constexpr uint8_t waveStep(const RuntimeConfig &c, uint8_t direction, uint8_t order) {
+  return direction == WAVE_DOWN ? c.numSteps - order : order + 1;
+}
+
+/**
+ * Wavefront position in lighting order, in 1/256 steps. Step `order` starts
+ * lighting when the front reaches order * 256 and ramps to full over
+ * WAVE_EDGE_WIDTH, so the front glides between steps instead of jumping.
+ */
+constexpr uint32_t waveFront(const RuntimeConfig &c, uint32_t elapsed) {
+  return (elapsed < waveLitTime(c) ? elapsed : waveLitTime(c)) * 256 / c.stepDelay;
+}
+
+// Number of steps fully behind the wavefront.
+constexpr uint8_t wavePassed(const RuntimeConfig &c, uint32_t elapsed) {
+  return waveFront(c, elapsed) < WAVE_EDGE_WIDTH ? 0
+       : (waveFront(c, elapsed) - WAVE_EDGE_WIDTH) / 256 + 1 > c.numSteps ? c.numSteps
+       : (waveFront(c, elapsed) - WAVE_EDGE_WIDTH) / 256 + 1;
+}
+
+// Anti-aliased level of a step from its distance behind the front.
+constexpr uint8_t edgeLevel(uint32_t front, uint8_t order) {
+  return front < (uint32_t)order * 256 ? 0
+       : front - (uint32_t)order * 256 >= WAVE_EDGE_WIDTH ? STEP_ON_LEVEL
+       : (front - (uint32_t)order * 256) * STEP_ON_LEVEL / WAVE_EDGE_WIDTH;
+}
+
+// Time from the trigger until a step starts lighting / clearing.
+constexpr uint32_t stepOnTime(const RuntimeConfig &c, uint8_t order) {
+  return (uint32_t)order * c.stepDelay;
+}
+
+constexpr uint32_t stepOffTime(const RuntimeConfig &c, const WaveTrigger &t, uint8_t order) {
+  return waveClearStart(c, t) + (uint32_t)(c.numSteps - 1 - order) * c.clearStepDelay;
+}
+
+// Linear fade: 0 at since == 0, STEP_ON_LEVEL once since reaches duration.
+constexpr uint8_t fadeLevel(uint32_t since, uint16_t duration) {
+  return since >= duration ? STEP_ON_LEVEL : since * STEP_ON_LEVEL / duration;
+}
+
+constexpr WavePhase wavePhase(const RuntimeConfig &c, const WaveTrigger &t, uint32_t elapsed) {
+  return t.direction == WAVE_NONE      ? PHASE_IDLE
+       : elapsed < waveLitTime(c)       ? PHASE_FILLING
+       : elapsed < waveClearStart(c, t) ? PHASE_HOLDING
+       : elapsed < waveEndTime(c, t)    ? PHASE_CLEARING
+       : PHASE_DONE;
+}
+
+constexpr uint8_t minLevel(uint8_t a, uint8_t b) { return a < b ? a : b; }
+
+constexpr uint8_t waveRiseLevel(const RuntimeConfig &c, uint8_t order, uint32_t elapsed) {
+  return minLevel(edgeLevel(waveFront(c, elapsed), order), fadeLevel(elapsed - stepOnTime(c, order), STEP_FADE_IN));
+}
+
+constexpr uint8_t waveLevelAt(const RuntimeConfig &c, const WaveTrigger &t, uint8_t order, uint32_t elapsed) {
+  return elapsed < stepOnTime(c, order) ? 0
+       : elapsed < stepOffTime(c, t, order)
+         ? waveRiseLevel(c, order, elapsed)
+         : minLevel(waveRiseLevel(c, order, elapsed),
+                    (uint8_t)(STEP_ON_LEVEL - fadeLevel(elapsed - stepOffTime(c, t, order), STEP_FADE_OUT)));
+}
+
+constexpr uint8_t waveLevel(const RuntimeConfig &c, const WaveTrigger &t, uint8_t step, uint32_t elapsed) {
+  return t.direction == WAVE_NONE ? 0 : waveLevelAt(c, t, waveOrder(c, t.direction, step), elapsed);
+}
+
+// Renders every step into levels[1..numSteps].
+inline void waveLevels(const RuntimeConfig &c, const WaveTrigger &t, uint32_t elapsed, uint8_t *levels) {
+  for (uint8_t step = 1; step <= c.numSteps; step++) {
+    levels[step] = waveLevel(c, t, step, elapsed);
+  }
+}
+
+/**
+ * Re-trigger while clearing: returns a wave in the same direction whose start
+ * is backdated so the steps still lit stay lit and filling resumes from there.
+ * The backdate puts every lit step fully behind the anti-aliased front and
+ * past its fade-in, so none of them dips while the front ramps up again.
+ */
+constexpr uint32_t waveResumeElapsed(const RuntimeConfig &c, uint8_t lit) {
+  uint32_t behindEdge = (uint32_t)lit * c.stepDelay + waveEdgeTime(c);
+  uint32_t pastFade = (uint32_t)(lit - 1) * c.stepDelay + STEP_FADE_IN;
+  uint32_t elapsed = behindEdge > pastFade ? behindEdge : pastFade;
+  return lit == 0 ? 0 : elapsed < waveLitTime(c) ? elapsed : waveLitTime(c);
+}
+
+constexpr WaveTrigger waveResume(const RuntimeConfig &c, const WaveTrigger &t, uint32_t elapsed) {
+  uint32_t backdate = waveResumeElapsed(c, c.numSteps - waveClearedCount(c, t, elapsed));
+  return WaveTrigger{t.direction, t.startMillis + elapsed - backdate, backdate};
+}
+
+#endif
@@ -0,0 +1,30 @@
+/**
+ * Per-step energy and lamp-hour accounting for maintenance planning.
+ *
+ * Nothing is sampled per frame: each step keeps its current estimated draw
+ * and is charged for the time since its last change only when one of its
+ * channels changes level. Totals are checkpointed to NVS every
+ * ENERGY_CHECKPOINT_INTERVAL into a ring of ENERGY_RING_SLOTS keys, written by
+ * a background task from a snapshot, so the DMX loop never waits on the NVS
+ * code. The flash write itself still pauses both cores (see energy.cpp), so a
+ * due checkpoint waits until the stairs are idle.
+ */
+
+#ifndef ENERGY_H
+#define ENERGY_H
+
+#include <stdint.h>
+
+// Loads the newest valid checkpoint and starts the checkpoint task.
+void energyBegin();
+
+// Called by the output stage when a sent channel value changes.
+void energyCharge(uint16_t channel, uint8_t oldValue, uint8_t newValue);
+
+// Hands a snapshot to the checkpoint task once the interval has elapsed and the stairs are idle.
+void energyCheckpoint(bool idle);
+
+// Prints lamp hours and Wh per step over serial.
+void reportEnergy();
+
+#endif
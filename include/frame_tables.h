@@ -0,0 +1,52 @@
+/**
+ * Precomputed wave frame tables.
+ *
+ * The fill and clear parts of both waves never change for a given build, so
+ * they are rendered at compile time from effects.h into delta-encoded tables
+ * that live in flash. Each table is a list of records, one per frame in which
+ * something changes:
+ *
+ *   [frames since previous record][change count]([step][level] * count)
+ *
+ * A gap longer than 255 frames is written as extra [255][0] records. Playback
+ * is a cursor walk over the records, so running a wave costs a few byte reads
+ * per frame instead of evaluating every step. The variable-length hold between
+ * fill and clear is simply "all lit" and needs no table.
+ */
+
+#ifndef FRAME_TABLES_H
+#define FRAME_TABLES_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "effects.h"
+
+enum TableSegment : uint8_t {
+  SEGMENT_UP_FILL,
+  SEGMENT_UP_CLEAR,
+  SEGMENT_DOWN_FILL,
+  SEGMENT_DOWN_CLEAR,
+  NUM_SEGMENTS
+};
+
+struct FrameTable {
+  const uint8_t *data;
+  uint16_t size;      // bytes
+  uint16_t frames;    // frames covered, FRAME_UPDATE_DELAY apart
+  uint8_t  baseLevel; // level of every step before the first record
+};
+
+extern const FrameTable frameTables[NUM_SEGMENTS];
+
+// True while the tables match what effects.h would render for c.
+bool frameTablesMatch(const RuntimeConfig &c);
+
+// Fills levels[1..NUM_OF_STEPS] for the wave at elapsed, decoding from the tables.
+void tableWaveLevels(const RuntimeConfig &c, const WaveTrigger &t, uint32_t elapsed, uint8_t *levels);
+
+size_t frameTablesFlashBytes();
+
+// Prints flash used by the tables against the render time they save.
+void reportFrameTables();
+
+#endif
@@ -0,0 +1,58 @@
+/**
+ * DMX output stage. Effects and scenes write into separate layers which are
+ * merged highest-takes-precedence into one frame, scaled by the ambient
+ * brightness and by the power limiter when the estimated load would exceed the
+ * show's supply budget, and sent to a universe sized for exactly the show's
+ * slots in a single bulk write when something changed.
+ */
+
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stdint.h>
+#include <DmxUniverse.h>
+#include <DmxRmt.h>
+#include <DmxParallel.h>
+#include "config.h"
+
+#if DMX_ENGINE == DMX_ENGINE_I2S
+constexpr uint8_t dmxParallelPins[] = {DMX_PARALLEL_PINS};
+typedef DmxParallelUniverses<sizeof(dmxParallelPins), show::dmxSlots> OutputUniverse;
+#elif DMX_ENGINE == DMX_ENGINE_RMT
+typedef DmxRmtUniverse<show::dmxSlots> OutputUniverse;
+#else
+typedef DmxUniverse<show::dmxSlots> OutputUniverse;
+#endif
+
+extern OutputUniverse dmx;
+
+void outputBegin();
+
+// Wave layer: writes a step's fixture channels, scaling its patched colour by level.
+void outputStep(uint8_t step, uint8_t level);
+
+// Scene layer: one DMX channel.
+void outputScene(uint16_t channel, uint8_t value);
+
+// Sends the merged frame if it changed since the last commit. Returns true if sent.
+bool outputCommit();
+
+// Prints the estimated load, budget and current limiter scale.
+void reportPower();
+
+// Starts the console input receiver when DMX_INPUT_ENABLE is set; it runs beside the output.
+void dmxInputBegin();
+
+// Prints frames received on the console input, their size and age, the
+// first slots and the receiver's signal-quality counters.
+void reportDmxInput();
+void resetDmxInputStats();
+
+// Prints the engine, CPU time per frame sent and the frame's wire time, next to the
+// RMT encode time of the same frame (UART and RMT builds) or the measured I2S wire time.
+void reportDmxBench();
+
+// RMT and I2S engines: re-encodes the current frame and checks it against the reference waveform.
+void reportDmxCheck();
+
+#endif
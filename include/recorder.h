@@ -0,0 +1,65 @@
+/**
+ * Output recorder: every DMX frame sent is appended to a delta-compressed
+ * stream in a flash ring, so a complaint like "step 7 flickered at 14:32"
+ * can be replayed later with tools/replay.py.
+ *
+ * The ring is the data partition the default partition table reserves for
+ * SPIFFS (unused by the firmware), in RECORD_BLOCK_SIZE blocks, one flash
+ * sector each. Every block is self-contained:
+ *
+ *   header  u32 magic "DRC1", u32 sequence, u32 session, u16 slots, u16 header size
+ *   records until the first 0xFF (erased) type byte:
+ *     'K'  u32 millis, slots bytes                       keyframe
+ *     'D'  u16 ms since the previous record, tokens       delta
+ *   A delta is the frame XORed with the previous one, run-length coded:
+ *   token 0x00-0x7F skips that many + 1 unchanged channels, 0x80-0xFF is
+ *   followed by (token & 0x7F) + 1 XOR bytes. Tokens cover all slots.
+ *
+ * A block always opens with a keyframe, and one is written at least every
+ * RECORD_KEYFRAME_INTERVAL, so a reader can seek by block and decode from
+ * there. All values are little endian; millis is the device uptime and the
+ * session is random per boot.
+ *
+ * A frame costs one pass over the slots into a RAM block, measured in CPU
+ * cycles; full blocks are written by a task on core 0, double-buffered, so
+ * the loop never waits for a write. When the writer falls behind, frames are
+ * dropped and counted and the next block restarts from a keyframe.
+ *
+ * Flash calls disable the cache on both cores, so the loop halts while they
+ * run. A sector erase takes tens of ms, so sectors are erased ahead of the
+ * write position, up to RECORD_ERASE_AHEAD, only while the stairs are idle
+ * and at most one per RECORD_ERASE_INTERVAL. A block is then only written
+ * into an erased sector, and if none is left, frames are dropped until
+ * the next idle spell. 'record' reports the measured erase and write stalls.
+ */
+
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <stdint.h>
+
+#define RECORD_BLOCK_SIZE  4096         // one flash sector
+#define RECORD_MAGIC       0x31435244   // "DRC1"
+
+// Finds the ring, continues after its newest block and starts the writer task.
+void recordBegin();
+
+// Called by the output stage with slots 1..dmxSlots of each frame sent.
+void recordFrame(uint32_t now, const uint8_t *slots);
+
+// Hands a partly filled block to the writer once it is RECORD_FLUSH_INTERVAL old, erases
+// the next sector ahead while the stairs are idle and continues a dump.
+void recordUpdate(uint32_t now, bool idle);
+
+// Writes out the current block now, e.g. before a dump.
+void recordFlush();
+
+// Starts printing the newest blocks as hex lines "R <sequence> <offset> <hex>" for tools/replay.py
+// undump. recordUpdate() prints them as the console drains, about 9 KB per block, so a dump
+// takes a few seconds at SERIAL_BAUD and the output keeps running meanwhile.
+void recordDump(uint16_t blocks);
+
+// Prints ring position, frames, bytes, drops, the per-frame cost and the flash stalls.
+void reportRecord();
+
+#endif
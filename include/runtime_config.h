@@ -0,0 +1,56 @@
+/**
+ * Site-tunable timing. The show file provides the defaults; on site they can
+ * be changed over serial, persisted to NVS and are loaded again at boot by a
+ * background task, so setup() never waits on flash; only a warm restart loads
+ * them synchronously, to resume its wave on the same timing.
+ *
+ * Two buffers back the block. Edits go into the one not in use, and the loop
+ * publishes it between frames by swapping the active pointer, so a frame is
+ * always rendered against one consistent block and readers need no lock.
+ */
+
+#ifndef RUNTIME_CONFIG_H
+#define RUNTIME_CONFIG_H
+
+#include <stdint.h>
+#include "config.h"
+
+struct RuntimeConfig {
+  uint8_t  numSteps;         // steps in use, 1..NUM_OF_STEPS; the rest stay dark
+  uint16_t debounceDelay;    // up to CONFIG_DEBOUNCE_MAX
+  uint16_t holdDelay;        // time the strip stays lit after the last trigger, at least waveRampTime()
+  uint16_t stepDelay;        // time between steps lighting
+  uint16_t clearStepDelay;   // time between steps clearing
+};
+
+constexpr RuntimeConfig showConfig = {
+  NUM_OF_STEPS, show::debounceDelay, show::holdDelay, show::stepDelay, show::clearStepDelay
+};
+
+// The block in use. Read once per frame and keep the reference for that frame.
+const RuntimeConfig &configActive();
+
+// Starts the background load of the persisted block.
+void configBegin();
+
+// Loads the persisted block and makes it active now, waiting on flash. For a
+// warm restart, whose restored wave must resume on the config it ran on.
+void configLoad();
+
+// Publishes a loaded or edited block. Called by the loop between frames.
+void configSwap();
+
+// Stages one field, by name, for the next swap. False on an unknown name, or if the block
+// would become invalid, e.g. a hold shorter than the fade-in or the edge.
+bool configSet(const char *name, uint32_t value);
+
+// Stages the show defaults.
+void configReset();
+
+// Writes the active block to NVS.
+void configSave();
+
+// Prints the active block and any staged changes.
+void reportConfig();
+
+#endif
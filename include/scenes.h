@@ -0,0 +1,30 @@
+/**
+ * Scene/cue engine. Scenes come from the show file as sparse channel/value
+ * lists. Going to a scene starts a crossfade only on the channels whose
+ * current and target values differ, each with its own fade time, and every
+ * frame walks just that active-fade list.
+ */
+
+#ifndef SCENES_H
+#define SCENES_H
+
+#include <stdint.h>
+
+#define NO_SCENE 0xFF
+
+extern uint8_t sceneCurrent;
+
+// Index of the named scene in show::scenes, or NO_SCENE.
+uint8_t sceneFind(const char *name);
+
+void sceneGo(uint8_t scene);
+
+// Jumps straight to a scene's levels, no fades. Only used at boot, before anything is lit.
+void sceneCut(uint8_t scene);
+
+// Advances the active fades and writes changed channels to the scene layer.
+void sceneRender(uint32_t now);
+
+uint16_t sceneActiveFades();
+
+#endif
@@ -0,0 +1,48 @@
+/**
+ * Presence sensor bank. SENSOR_BANK in config.h lists the inputs with their
+ * role: stair ends, landings and individual steps. A timer samples the whole
+ * bank every SENSOR_SAMPLE_INTERVAL from the GPIO input registers and filters
+ * every input at once by majority vote: a level changes once
+ * SENSOR_FILTER_VOTES of the last SENSOR_FILTER_WINDOW samples agree.
+ * Filtered changes are queued as bitmasks with their timestamps, and
+ * sensorsPoll() only visits the bits that changed.
+ *
+ * An input triggers on its rising edge, so a person standing in the beam
+ * gives one trigger, not one per debounce period. Each input's health is
+ * tracked: one held high for SENSOR_STUCK_HIGH_TIME, or an end that has seen
+ * no edge for SENSOR_STUCK_LOW_TIME while another end triggered
+ * SENSOR_STUCK_LOW_TRIGGERS times, is flagged stuck. A flagged input triggers
+ * nothing until it has shown SENSOR_RECOVERY_TRIGGERS clean triggers in a row,
+ * each at least SENSOR_RECOVERY_GAP after the edge before it, so a chattering
+ * beam stays ignored. The staircase then runs on the remaining ends.
+ */
+
+#ifndef SENSORS_H
+#define SENSORS_H
+
+#include <stdint.h>
+
+enum SensorRole : uint8_t {
+  SENSOR_END,       // index: WAVE_UP at the bottom, WAVE_DOWN at the top
+  SENSOR_LANDING,   // index: step number of the landing
+  SENSOR_STEP       // index: step number
+};
+
+enum SensorHealth : uint8_t {
+  SENSOR_OK,
+  SENSOR_STUCK_HIGH,
+  SENSOR_STUCK_LOW
+};
+
+void sensorsBegin();
+
+// Handles queued edges and calls onTrigger(role, index) for each new trigger of a healthy input.
+void sensorsPoll(uint32_t now, void (*onTrigger)(uint8_t role, uint8_t index));
+
+// True while some but not all end sensors are flagged.
+bool sensorsSingleMode();
+
+// Prints pin, role, level and health of each input.
+void reportSensors();
+
+#endif
@@ -0,0 +1,112 @@
+/**
+ * Generated by tools/showc.py from shows/gitex.json - do not edit.
+ * Show: GITEX Global interactive staircase
+ */
+
+#ifndef SHOW_H
+#define SHOW_H
+
+#include <stdint.h>
+
+namespace show {
+
+constexpr uint8_t  numSteps       = 16;
+constexpr uint16_t debounceDelay  = 500;
+constexpr uint16_t frameDelay     = 20;
+constexpr uint16_t stepDelay      = 500;
+constexpr uint16_t holdDelay      = 10000;
+constexpr uint16_t clearStepDelay = 150;
+constexpr uint16_t fadeInDelay    = 0;
+constexpr uint16_t fadeOutDelay   = 0;
+constexpr uint8_t  onLevel        = 255;
+constexpr uint16_t edgeWidth      = 384;   // wavefront ramp, 1/256 steps
+constexpr uint8_t  tailFloor      = 255;
+constexpr uint16_t tailHalfLife   = 0;   // ms (0 = no tail)
+
+constexpr uint16_t footprint      = 1;   // DMX channels per step
+constexpr uint16_t dmxSlots       = 16;   // highest patched or cued channel
+
+// First DMX channel of each step, indexed by step - 1.
+constexpr uint16_t patch[numSteps] = {
+    1,   2,   3,   4,   5,   6,   7,   8,
+    9,  10,  11,  12,  13,  14,  15,  16,
+};
+
+// Value of each fixture channel at full step level, indexed by step - 1.
+constexpr uint8_t colour[numSteps][footprint] = {
+  {255},
+  {255},
+  {255},
+  {255},
+  {255},
+  {255},
+  {255},
+  {255},
+  {255},
+  {255},
+  {255},
+  {255},
+  {255},
+  {255},
+  {255},
+  {255},
+};
+
+constexpr uint32_t powerBudget    = 320000;   // mW, 0 = no limit
+constexpr uint8_t  powerHysteresis = 5;   // percent
+
+// Draw of each DMX channel at full level in mW, indexed by channel.
+constexpr uint16_t channelMilliwatts[dmxSlots + 1] = {
+      0, 24000, 24000, 24000, 24000, 24000, 24000, 24000,
+  24000, 24000, 24000, 24000, 24000, 24000, 24000, 24000,
+  24000,
+};
+
+struct SceneCue {
+  uint16_t channel;
+  uint8_t  value;
+  uint16_t fadeMillis;   // 0 = scene default
+};
+
+struct Scene {
+  const char *name;
+  uint16_t firstCue;     // index into sceneCues
+  uint16_t cueCount;
+  uint16_t fadeMillis;
+};
+
+constexpr uint16_t numSceneCues = 18;
+constexpr SceneCue sceneCues[numSceneCues] = {
+  {  1,  60,     0},
+  { 16,  60,     0},
+  {  1,  24,   300},
+  {  2,  12,     0},
+  {  3,  12,     0},
+  {  4,  12,     0},
+  {  5,  12,     0},
+  {  6,  12,     0},
+  {  7,  12,     0},
+  {  8,  12,     0},
+  {  9,  12,     0},
+  { 10,  12,     0},
+  { 11,  12,     0},
+  { 12,  12,     0},
+  { 13,  12,     0},
+  { 14,  12,     0},
+  { 15,  12,     0},
+  { 16,  24,   300},
+};
+
+constexpr uint8_t numScenes = 3;
+constexpr Scene scenes[numScenes] = {
+  {"idle", 0, 0, 2000},
+  {"welcome", 0, 2, 1500},
+  {"walk", 2, 16, 800},
+};
+
+static_assert(dmxSlots <= 512, "show patch exceeds one DMX universe");
+static_assert(numSteps < 255, "step loops count to numSteps in uint8_t");
+
+}  // namespace show
+
+#endif
@@ -0,0 +1,30 @@
+/**
+ * Runtime health statistics: free heap, largest free block, low-water mark
+ * and the stack high-water mark of every firmware task.
+ *
+ * Built with HEAP_GUARD (the esp32dev-heapguard environment), malloc, calloc
+ * and realloc are wrapped at link time. After statsArm() at the end of
+ * setup() every allocation is counted with its caller, and with
+ * HEAP_GUARD_TRAP one made from the loop task aborts, so the panic backtrace
+ * points at it. Serial commands are run with the guard paused: they are
+ * maintenance paths, not the staircase or DMX paths.
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <Arduino.h>
+
+// Adds a task to the stack report. Up to STATS_MAX_TASKS.
+void statsRegisterTask(TaskHandle_t task);
+
+// Marks the end of setup(); from here on allocations are counted.
+void statsArm();
+
+// Suspends counting and trapping on the loop task while paused is true.
+void statsPause(bool paused);
+
+// Prints heap figures, allocation counts and stack high-water marks.
+void reportStats();
+
+#endif
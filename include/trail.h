@@ -0,0 +1,26 @@
+/**
+ * Follow-me trail mode. Each trigger starts a walker whose position is
+ * estimated from its trigger time and the learned time to walk the whole
+ * staircase; only a window of TRAIL_BEHIND..TRAIL_AHEAD steps around it is
+ * lit. A trigger at the far end shortly after an entry is taken as that walker
+ * arriving and refines the learned traversal time. Steps are reference
+ * counted per walker, so each frame only touches the steps where a window
+ * edge moved. Step count and pace come from the active runtime config; a
+ * change of numSteps clears the trail and the learned time.
+ */
+
+#ifndef TRAIL_H
+#define TRAIL_H
+
+#include <stdint.h>
+
+// Sensor trigger in trail mode: WAVE_UP from the bottom sensor, WAVE_DOWN from the top.
+void trailTrigger(uint8_t direction, uint32_t now);
+
+// Moves every walker's window to now and copies the trail into levels[1..NUM_OF_STEPS].
+void trailLevels(uint32_t now, uint8_t *levels);
+
+bool trailActive();
+uint32_t trailTraversalMillis();
+
+#endif
@@ -0,0 +1,31 @@
+/**
+ * Warm-restart snapshot. The sequencer state and the levels last sent to
+ * each step are mirrored into RTC slow memory, which survives watchdog,
+ * panic, software and (usually) brownout resets. It is rewritten and
+ * re-checksummed only when something in it changes; the frame timestamp
+ * is stored outside the checksum so keeping it current costs one store.
+ * After such a reset the firmware resumes from the snapshot instead of
+ * going through the cold boot look.
+ */
+
+#ifndef WARM_START_H
+#define WARM_START_H
+
+#include <stdint.h>
+#include "effects.h"
+
+struct WarmState {
+  WaveTrigger wave;                    // times rebased to the new millis() on restore
+  uint8_t mode;                        // MODE_WAVE or MODE_TRAIL
+  uint8_t scene;                       // scene engine's current scene
+  uint8_t levels[NUM_OF_STEPS + 1];    // last level sent, indexed by step
+};
+
+// Fills state from a valid snapshot after a warm reset. False on a cold boot,
+// a bad checksum, or after WARM_MAX_RESTORES warm restarts in a row.
+bool warmRestore(WarmState &state);
+
+// Mirrors the live state; called once per rendered frame.
+void warmUpdate(uint32_t now, const WaveTrigger &wave, uint8_t mode, uint8_t scene, const uint8_t *levels);
+
+#endif
@@ -0,0 +1,19 @@
+/**
+ * Optional exponential tail behind the wavefront. Steps the front has passed
+ * flash to full and then decay towards WAVE_TAIL_FLOOR, halving every
+ * WAVE_TAIL_HALF_LIFE ms after the front passed them. The level is taken from
+ * that time, not stepped per frame, so the idle frame rate doesn't slow it.
+ * Only the steps still decaying are evaluated; the settled ones are a single
+ * run at the floor.
+ */
+
+#ifndef WAVE_TAIL_H
+#define WAVE_TAIL_H
+
+#include <stdint.h>
+#include "effects.h"
+
+// Limits levels[1..NUM_OF_STEPS] to the tail for the wave at elapsed. No-op without a tail.
+void tailApply(const RuntimeConfig &c, const WaveTrigger &t, uint32_t elapsed, uint8_t *levels);
+
+#endif
@@ -0,0 +1,119 @@
+/******************************************************************************
+DmxParallel.cpp
+I2S1 LCD-mode transmit engine for DmxParallelUniverses.
+
+This code is released under the [MIT License](http://opensource.org/licenses/MIT).
+******************************************************************************/
+
+#include <Arduino.h>
+#include <driver/periph_ctrl.h>
+#include <rom/lldesc.h>
+#include <soc/gpio_sig_map.h>
+#include <soc/i2s_struct.h>
+
+#include "DmxParallel.h"
+
+#define DMX_DESCRIPTOR_BYTES  4092   // largest word-aligned DMA descriptor
+
+extern int enablePin;
+
+DmxParallelEngine dmxParallel;
+
+static DRAM_ATTR lldesc_t descriptors[DMX_PARALLEL_DESCRIPTORS];
+
+// Clears the transmitter and DMA state so the next frame starts from its first sample.
+static void resetTransmitter() {
+  I2S1.conf.tx_start = 0;
+  I2S1.conf.tx_reset = 1;
+  I2S1.conf.tx_reset = 0;
+  I2S1.conf.tx_fifo_reset = 1;
+  I2S1.conf.tx_fifo_reset = 0;
+  I2S1.lc_conf.out_rst = 1;
+  I2S1.lc_conf.out_rst = 0;
+}
+
+void DmxParallelEngine::begin(const uint8_t *pins, uint8_t lines) {
+  periph_module_enable(PERIPH_I2S1_MODULE);
+  resetTransmitter();
+
+  // 16-bit LCD mode. Sample clock per the TRM's I2S chapter:
+  //   clka_en = 0 selects PLL_D2_CLK, 160 MHz
+  //   fI2S = 160 MHz / (clkm_div_num + b / a) = 160 MHz / 80 = 2 MHz
+  //   fBCK = fI2S / tx_bck_div_num = 500 kHz
+  //   LCD master transmit with lcd_tx_wrx2_en and lcd_tx_sdx2_en clear (conf2 is
+  //   lcd_en only) holds each sample for two BCK cycles: 250 kHz, 4 us per DMX bit.
+  // 'dmx bench' prints the wire time measured from the transmitter's idle flag
+  // next to sampleCount * 4 us, which catches a board where this doesn't hold.
+  I2S1.conf2.val = 0;
+  I2S1.conf2.lcd_en = 1;
+  I2S1.clkm_conf.val = 0;
+  I2S1.clkm_conf.clka_en = 0;
+  I2S1.clkm_conf.clkm_div_num = 80;
+  I2S1.clkm_conf.clkm_div_a = 1;
+  I2S1.clkm_conf.clkm_div_b = 0;
+  I2S1.clkm_conf.clk_en = 1;
+  I2S1.sample_rate_conf.val = 0;
+  I2S1.sample_rate_conf.tx_bits_mod = 16;
+  I2S1.sample_rate_conf.tx_bck_div_num = 4;
+  I2S1.fifo_conf.val = 0;
+  I2S1.fifo_conf.tx_fifo_mod_force_en = 1;
+  I2S1.fifo_conf.tx_fifo_mod = 1;   // 16-bit single channel
+  I2S1.fifo_conf.tx_data_num = 32;
+  I2S1.fifo_conf.dscr_en = 1;
+  I2S1.conf1.val = 0;
+  I2S1.conf1.tx_stop_en = 1;        // hold the last sample, a mark, once the DMA runs dry
+  I2S1.conf1.tx_pcm_bypass = 1;
+  I2S1.conf_chan.val = 0;
+  I2S1.conf_chan.tx_chan_mod = 1;
+  I2S1.timing.val = 0;
+  I2S1.int_ena.val = 0;
+
+  for (uint8_t l = 0; l < lines; l++) {
+    pinMode(pins[l], OUTPUT);
+    digitalWrite(pins[l], HIGH);
+    pinMatrixOutAttach(pins[l], I2S1O_DATA_OUT8_IDX + l, false, false);   // 16-bit mode uses the upper data bus
+  }
+  pinMode(enablePin, OUTPUT);   // the shield's transceiver, when a line is on its TX pin
+  digitalWrite(enablePin, HIGH);
+}
+
+bool DmxParallelEngine::send(const uint16_t *samples, size_t count) {
+  size_t bytes = count * sizeof(uint16_t);
+  if (count == 0 || bytes > DMX_PARALLEL_DESCRIPTORS * DMX_DESCRIPTOR_BYTES) { return false; }
+
+  uint8_t n = 0;
+  for (size_t offset = 0; offset < bytes; offset += DMX_DESCRIPTOR_BYTES, n++) {
+    size_t length = bytes - offset < DMX_DESCRIPTOR_BYTES ? bytes - offset : DMX_DESCRIPTOR_BYTES;
+    lldesc_t &d = descriptors[n];
+    d.size = length;
+    d.length = length;
+    d.offset = 0;
+    d.sosf = 0;
+    d.eof = offset + length == bytes;
+    d.owner = 1;
+    d.buf = (uint8_t *)samples + offset;
+    d.qe.stqe_next = d.eof ? nullptr : &descriptors[n + 1];
+  }
+
+  resetTransmitter();
+  I2S1.out_link.addr = (uint32_t)(uintptr_t)&descriptors[0];
+  I2S1.out_link.start = 1;
+  startMicros = micros();
+  frameMicros = count * 4;
+  I2S1.conf.tx_start = 1;
+  return true;
+}
+
+// Timed rather than taken from the DMA end-of-frame interrupt: that fires
+// when the last descriptor is read, while the FIFO still holds samples.
+bool DmxParallelEngine::idle() {
+  return micros() - startMicros >= frameMicros + 16;
+}
+
+uint32_t DmxParallelEngine::measure() {
+  for (;;) {
+    uint32_t elapsed = micros() - startMicros;
+    if (elapsed >= frameMicros / 2 && I2S1.state.tx_idle) { return elapsed; }
+    if (elapsed > frameMicros * 3) { return 0; }
+  }
+}
@@ -0,0 +1,95 @@
+/******************************************************************************
+DmxParallel.h
+I2S-parallel transmit engine: up to 8 DMX universes sent together from one
+peripheral. The universes are transposed into 16-bit I2S samples, one per
+4 us bit time with bit n driving line n, and clocked out by DMA, so every
+line shares the same timing and the CPU only encodes.
+
+Uses I2S1 (I2S0 runs the ADC DMA). A full 512-slot frame is about 11 KB of
+samples in DRAM.
+
+This code is released under the [MIT License](http://opensource.org/licenses/MIT).
+******************************************************************************/
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <string.h>
+#include "DmxParallelEncoder.h"
+
+#ifndef DmxParallel_h
+#define DmxParallel_h
+
+#define DMX_PARALLEL_DESCRIPTORS  4   // DMA descriptors of up to 4092 bytes, enough for 512 slots
+
+class DmxParallelEngine {
+public:
+  // Routes I2S1 data lines 0..lines-1 to pins and sets the 250 kHz sample clock.
+  void begin(const uint8_t *pins, uint8_t lines);
+  // Starts DMA of count samples. The buffer must stay untouched until idle().
+  bool send(const uint16_t *samples, size_t count);
+  // True once the last frame has been clocked out.
+  bool idle();
+  // Busy-waits for the transmitter's idle flag on the frame in flight, up to three
+  // times its expected length. Returns its wire time in us, or 0 if the flag never rose.
+  uint32_t measure();
+
+private:
+  uint32_t startMicros = 0;
+  uint32_t frameMicros = 0;
+};
+
+extern DmxParallelEngine dmxParallel;
+
+// Lines universes of Slots slots each, with their sample buffer sized at compile time.
+template <uint8_t Lines, uint16_t Slots>
+class DmxParallelUniverses {
+  static_assert(Lines >= 1 && Lines <= DMX_PARALLEL_MAX_LINES, "the I2S engine drives 1 to 8 lines");
+  static_assert(Slots >= 1 && Slots <= 512, "a DMX universe has 1 to 512 slots");
+
+public:
+  static constexpr uint8_t lines = Lines;
+  static constexpr uint16_t slots = Slots;
+  static constexpr uint16_t packetSize = Slots + 1;   // start code included
+  static constexpr size_t sampleCount = dmxParallelSamples(packetSize);
+  static constexpr uint32_t frameMicros = sampleCount * 4;
+  static constexpr uint32_t maxRefreshHz = 1000000 / frameMicros;
+
+  void begin(const uint8_t (&pins)[Lines]) {
+    for (uint8_t l = 0; l < Lines; l++) { packets[l] = data[l]; sizes[l] = packetSize; }
+    dmxParallel.begin(pins, Lines);
+  }
+
+  // Channels are 1..Slots; out of range lines and channels are ignored.
+  void write(uint8_t line, uint16_t channel, uint8_t value) {
+    if (line < Lines && channel >= 1 && channel <= Slots) { data[line][channel] = value; }
+  }
+
+  void write(uint8_t line, uint16_t startChannel, const uint8_t *values, uint16_t count) {
+    if (line >= Lines || startChannel < 1 || startChannel > Slots) { return; }
+    if (count > Slots + 1 - startChannel) { count = Slots + 1 - startChannel; }
+    memcpy(&data[line][startChannel], values, count);
+  }
+
+  uint8_t read(uint8_t line, uint16_t channel) const {
+    return line < Lines && channel <= Slots ? data[line][channel] : 0;
+  }
+
+  // Waits for the previous frame, then encodes and starts all lines.
+  void update() {
+    while (!dmxParallel.idle()) {}
+    size_t count = dmxParallelEncode(samples, sampleCount, packets, sizes, Lines);
+    dmxParallel.send(samples, count);
+  }
+
+  // Encodes into the sample buffer without sending, for checks and benchmarks.
+  size_t encode() { return dmxParallelEncode(samples, sampleCount, packets, sizes, Lines); }
+  bool verify(size_t count) const { return dmxParallelVerify(samples, count, packets, sizes, Lines); }
+
+private:
+  uint8_t data[Lines][packetSize] = {};   // data[line][0] is the start code, always 0
+  const uint8_t *packets[Lines] = {};
+  uint16_t sizes[Lines] = {};
+  alignas(4) uint16_t samples[sampleCount] = {};
+};
+
+#endif
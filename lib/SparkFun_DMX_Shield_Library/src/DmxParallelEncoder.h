@@ -0,0 +1,101 @@
+/******************************************************************************
+DmxParallelEncoder.h
+Encodes up to 8 DMX packets as parallel I2S samples, one sample per 4 us
+bit time, bit n of each sample driving line n. Platform independent: no
+Arduino or IDF headers, so it builds and can be checked on a host.
+
+Every line shares the frame timing: break, mark after break, then per slot
+a start bit, eight data bits LSB first and two stop bits. A slot's eight
+line bytes are transposed as one 8x8 bit matrix in a 64-bit word, so a
+slot costs the same few shifts and masks whether one line or eight are in
+use. A line whose packet is shorter than the longest idles high (mark)
+for the rest of the frame.
+
+The ESP32 I2S FIFO sends the two 16-bit samples of each 32-bit word high
+half first, so sample i is stored at index i ^ 1; dmxParallelSample()
+reads them back in wire order.
+
+This code is released under the [MIT License](http://opensource.org/licenses/MIT).
+******************************************************************************/
+
+#include <inttypes.h>
+#include <stddef.h>
+#include "DmxRmtEncoder.h"
+
+#ifndef DmxParallelEncoder_h
+#define DmxParallelEncoder_h
+
+#define DMX_PARALLEL_MAX_LINES   8
+#define DMX_PARALLEL_BREAK_BITS  23   // 92 us
+#define DMX_PARALLEL_MAB_BITS    3    // 12 us
+#define DMX_PARALLEL_TAIL_BITS   2    // mark after the last slot, the lines' idle level
+
+// Samples for a frame whose longest packet is packetSize bytes, rounded up to whole 32-bit words.
+constexpr size_t dmxParallelSamples(uint16_t packetSize) {
+  return ((size_t)DMX_PARALLEL_BREAK_BITS + DMX_PARALLEL_MAB_BITS + 11UL * packetSize + DMX_PARALLEL_TAIL_BITS + 1) & ~(size_t)1;
+}
+
+// The per-bit timing of dmxReferenceLevel() that the samples follow.
+constexpr DmxRmtTiming dmxParallelTiming = {DMX_PARALLEL_BREAK_BITS, DMX_PARALLEL_MAB_BITS, 1};
+
+// Transposes an 8x8 bit matrix: bit c of byte r moves to bit r of byte c.
+inline uint64_t dmxTranspose8(uint64_t x) {
+  uint64_t t;
+  t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;  x ^= t ^ (t << 7);
+  t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL; x ^= t ^ (t << 14);
+  t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL; x ^= t ^ (t << 28);
+  return x;
+}
+
+inline uint16_t dmxParallelSample(const uint16_t *samples, size_t i) {
+  return samples[i ^ 1];
+}
+
+/**
+ * Writes the frame for packets[0..lines) of sizes[0..lines) into samples.
+ * Lines at or above `lines` idle high. Returns the number of samples, or 0
+ * if they don't fit capacity.
+ */
+inline size_t dmxParallelEncode(uint16_t *samples, size_t capacity, const uint8_t *const *packets,
+                                const uint16_t *sizes, uint8_t lines) {
+  uint16_t longest = 0;
+  for (uint8_t l = 0; l < lines; l++) { if (sizes[l] > longest) { longest = sizes[l]; } }
+  size_t count = dmxParallelSamples(longest);
+  if (lines > DMX_PARALLEL_MAX_LINES || count > capacity) { return 0; }
+
+  const uint16_t unused = (uint16_t)(0xFF << lines) & 0xFF;
+  size_t i = 0;
+  for (uint8_t b = 0; b < DMX_PARALLEL_BREAK_BITS; b++) { samples[i++ ^ 1] = unused; }
+  for (uint8_t b = 0; b < DMX_PARALLEL_MAB_BITS; b++) { samples[i++ ^ 1] = 0xFF; }
+
+  for (uint16_t slot = 0; slot < longest; slot++) {
+    uint64_t x = 0;
+    uint16_t idle = unused;
+    for (uint8_t l = 0; l < lines; l++) {
+      if (slot < sizes[l]) { x |= (uint64_t)packets[l][slot] << (8 * l); }
+      else { idle |= 1 << l; }
+    }
+    x = dmxTranspose8(x);
+    samples[i++ ^ 1] = idle;                     // start bit
+    for (uint8_t b = 0; b < 8; b++, x >>= 8) { samples[i++ ^ 1] = (uint16_t)(x & 0xFF) | idle; }
+    samples[i++ ^ 1] = 0xFF;                     // stop bits
+    samples[i++ ^ 1] = 0xFF;
+  }
+  while (i < count) { samples[i++ ^ 1] = 0xFF; }
+  return count;
+}
+
+// Checks every line of every sample against the per-line reference waveform. True if they match.
+inline bool dmxParallelVerify(const uint16_t *samples, size_t count, const uint8_t *const *packets,
+                              const uint16_t *sizes, uint8_t lines) {
+  for (size_t i = 0; i < count; i++) {
+    uint16_t sample = dmxParallelSample(samples, i);
+    for (uint8_t l = 0; l < DMX_PARALLEL_MAX_LINES; l++) {
+      uint8_t expected = l < lines ? dmxReferenceLevel(packets[l], sizes[l], dmxParallelTiming, i) : 1;
+      if ((sample >> l & 1) != expected) { return false; }
+    }
+  }
+  return true;
+}
+
+#endif
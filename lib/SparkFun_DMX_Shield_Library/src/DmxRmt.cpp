@@ -0,0 +1,52 @@
+/******************************************************************************
+DmxRmt.cpp
+RMT transmit engine for DmxRmtUniverse.
+
+This code is released under the [MIT License](http://opensource.org/licenses/MIT).
+******************************************************************************/
+
+#include <Arduino.h>
+#include <driver/rmt.h>
+
+#include "DmxUart.h"
+#include "DmxRmt.h"
+
+#define DMX_RMT_CHANNEL  RMT_CHANNEL_0
+
+extern int enablePin;
+extern int txPin;
+
+DmxRmtEngine dmxRmt;
+
+// 80 MHz APB / 80 = 1 us ticks.
+static const DmxRmtTiming timing = {DMX_BREAK_MICROS, DMX_MAB_MICROS, 4};
+
+void DmxRmtEngine::begin(uint16_t packetSize) {
+  size_t items = dmxRmtItems(packetSize);
+  size_t blocks = (items + 63) / 64;
+
+  rmt_config_t config = RMT_DEFAULT_CONFIG_TX((gpio_num_t)txPin, DMX_RMT_CHANNEL);
+  config.clk_div = 80;
+  config.mem_block_num = blocks > 8 ? 8 : blocks;
+  config.tx_config.carrier_en = false;
+  config.tx_config.idle_output_en = true;
+  config.tx_config.idle_level = RMT_IDLE_LEVEL_HIGH;   // mark between frames
+  rmt_config(&config);
+  rmt_driver_install(DMX_RMT_CHANNEL, 0, 0);
+
+  pinMode(enablePin, OUTPUT);
+  digitalWrite(enablePin, HIGH);
+}
+
+bool DmxRmtEngine::send(const uint8_t *packet, uint16_t size, uint32_t *items, size_t capacity) {
+  rmt_wait_tx_done(DMX_RMT_CHANNEL, portMAX_DELAY);   // items still being read by the peripheral
+  DmxRmtEncoder encoder(items, capacity);
+  size_t count = encoder.encode(packet, size, timing);
+  if (count == 0) { return false; }
+  rmt_write_items(DMX_RMT_CHANNEL, (const rmt_item32_t *)items, count, false);
+  return true;
+}
+
+bool DmxRmtEngine::idle() {
+  return rmt_wait_tx_done(DMX_RMT_CHANNEL, 0) == ESP_OK;
+}
@@ -0,0 +1,48 @@
+/******************************************************************************
+DmxRmt.h
+RMT transmit engine: the whole frame, break and mark-after-break included,
+is encoded as RMT items and clocked out by the peripheral, so the CPU only
+encodes and hands the buffer over instead of waiting out the frame.
+
+A frame whose items fit the channel's RAM blocks (up to 8 x 64 items, about
+100 slots) goes out with no CPU involvement; longer ones are refilled from
+the driver's interrupt.
+
+This code is released under the [MIT License](http://opensource.org/licenses/MIT).
+******************************************************************************/
+
+#include <inttypes.h>
+#include <stddef.h>
+#include "DmxRmtEncoder.h"
+#include "DmxUniverse.h"
+
+#ifndef DmxRmt_h
+#define DmxRmt_h
+
+class DmxRmtEngine {
+public:
+  // Installs the RMT driver on the TX pin, sized for packets of packetSize bytes.
+  void begin(uint16_t packetSize);
+  // Waits for the previous frame, encodes packet into items and starts sending.
+  // Returns false if the items don't fit.
+  bool send(const uint8_t *packet, uint16_t size, uint32_t *items, size_t capacity);
+  // True once the last frame has left the peripheral.
+  bool idle();
+};
+
+extern DmxRmtEngine dmxRmt;
+
+// A DmxUniverse sent through the RMT engine, with its item buffer sized at compile time.
+template <uint16_t Slots>
+class DmxRmtUniverse : public DmxUniverse<Slots> {
+public:
+  static constexpr size_t itemCount = dmxRmtItems(Slots + 1);
+
+  void begin() { dmxRmt.begin(Slots + 1); }
+  void update() { dmxRmt.send(this->data, Slots + 1, items, itemCount); }
+
+private:
+  uint32_t items[itemCount] = {};
+};
+
+#endif
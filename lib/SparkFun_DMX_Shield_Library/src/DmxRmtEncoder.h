@@ -0,0 +1,111 @@
+/******************************************************************************
+DmxRmtEncoder.h
+Encodes a DMX packet as ESP32 RMT items. Platform independent: no Arduino
+or IDF headers, so it builds and can be checked on a host.
+
+The line is a sequence of level runs: break (low), mark after break (high),
+then per slot a low start bit, eight data bits LSB first and two high stop
+bits. Adjacent bits of the same level are merged into one run, and two runs
+are packed per 32-bit item in the RMT layout
+  [duration0:15][level0:1][duration1:15][level1:1]  (LSB first)
+ending with a zero-duration half that stops the transmitter. The line then
+idles high, which is the mark between frames.
+
+This code is released under the [MIT License](http://opensource.org/licenses/MIT).
+******************************************************************************/
+
+#include <inttypes.h>
+#include <stddef.h>
+
+#ifndef DmxRmtEncoder_h
+#define DmxRmtEncoder_h
+
+struct DmxRmtTiming {
+  uint16_t breakTicks;
+  uint16_t mabTicks;
+  uint16_t bitTicks;   // 4 us at the chosen tick
+};
+
+// Worst case: ten runs per slot (alternating bits), break, MAB and the end marker.
+constexpr size_t dmxRmtItems(uint16_t packetSize) {
+  return ((size_t)packetSize * 10 + 3 + 1) / 2;
+}
+
+class DmxRmtEncoder {
+public:
+  DmxRmtEncoder(uint32_t *items, size_t capacity) : items(items), capacity(capacity) {}
+
+  // Returns the number of items written, or 0 if they don't fit. An encoder
+  // can be reused; each call starts over, whatever the last one returned.
+  size_t encode(const uint8_t *packet, uint16_t size, const DmxRmtTiming &t) {
+    count = 0;
+    half = false;
+    overflow = false;
+    runLevel = 0;
+    runTicks = t.breakTicks;
+    level(1, t.mabTicks);
+    for (uint16_t i = 0; i < size; i++) {
+      uint16_t frame = (uint16_t)packet[i] << 1 | 0x600;   // start bit 0, data, two stop bits
+      for (uint8_t bit = 0; bit < 11; bit++) { level(frame >> bit & 1, t.bitTicks); }
+    }
+    emit(runLevel, runTicks);
+    emit(0, 0);   // end marker
+    return overflow ? 0 : count + (half ? 1 : 0);
+  }
+
+private:
+  void level(uint8_t value, uint16_t ticks) {
+    if (value == runLevel && runTicks + ticks <= 0x7FFF) { runTicks += ticks; return; }
+    emit(runLevel, runTicks);
+    runLevel = value;
+    runTicks = ticks;
+  }
+
+  void emit(uint8_t value, uint16_t ticks) {
+    if (count >= capacity) { overflow = true; return; }
+    uint32_t bits = (uint32_t)ticks | (uint32_t)value << 15;
+    if (!half) { items[count] = bits; half = true; return; }
+    items[count++] |= bits << 16;
+    half = false;
+  }
+
+  uint32_t *items;
+  size_t capacity;
+  size_t count = 0;
+  bool half = false;
+  bool overflow = false;
+  uint8_t runLevel = 0;
+  uint16_t runTicks = 0;
+};
+
+// Reference: the line level at a tick, computed bit by bit from the packet.
+inline uint8_t dmxReferenceLevel(const uint8_t *packet, uint16_t size, const DmxRmtTiming &t, uint32_t tick) {
+  if (tick < t.breakTicks) { return 0; }
+  tick -= t.breakTicks;
+  if (tick < t.mabTicks) { return 1; }
+  tick -= t.mabTicks;
+  uint32_t slot = tick / (11U * t.bitTicks);
+  if (slot >= size) { return 1; }
+  uint8_t bit = tick % (11U * t.bitTicks) / t.bitTicks;
+  return bit == 0 ? 0 : bit >= 9 ? 1 : packet[slot] >> (bit - 1) & 1;
+}
+
+// Replays encoded items tick by tick against the reference. True if they match.
+inline bool dmxRmtVerify(const uint32_t *items, size_t count, const uint8_t *packet, uint16_t size,
+                         const DmxRmtTiming &t) {
+  uint32_t tick = 0;
+  for (size_t i = 0; i < count; i++) {
+    for (uint8_t h = 0; h < 2; h++) {
+      uint16_t bits = items[i] >> (16 * h);
+      uint16_t ticks = bits & 0x7FFF;
+      uint8_t value = bits >> 15;
+      if (ticks == 0) { return tick == (t.breakTicks + t.mabTicks + 11UL * t.bitTicks * size); }
+      for (uint16_t k = 0; k < ticks; k++, tick++) {
+        if (dmxReferenceLevel(packet, size, t, tick) != value) { return false; }
+      }
+    }
+  }
+  return false;   // no end marker
+}
+
+#endif
@@ -0,0 +1,191 @@
+/******************************************************************************
+DmxRx.cpp
+UART1 receive engine, see DmxRx.h.
+
+This code is released under the [MIT License](http://opensource.org/licenses/MIT).
+******************************************************************************/
+
+#include <Arduino.h>
+#include <driver/periph_ctrl.h>
+#include <esp_intr_alloc.h>
+#include <esp_ipc.h>
+#include <driver/gpio.h>
+#include <hal/gpio_ll.h>
+#include <hal/uart_ll.h>
+#include <soc/gpio_sig_map.h>
+#include <soc/gpio_struct.h>
+
+#include "DmxUart.h"
+#include "DmxRx.h"
+
+#define DMX_RX_INTERRUPTS  (UART_INTR_RXFIFO_FULL | UART_INTR_RXFIFO_TOUT | UART_INTR_BRK_DET | UART_INTR_RXFIFO_OVF | \
+                            UART_INTR_FRAM_ERR)
+
+DmxRxEngine dmxRx;
+
+static uart_dev_t *const rxUart = UART_LL_GET_HW(1);
+static intr_handle_t rxInterrupt = nullptr;
+static portMUX_TYPE rxMux = portMUX_INITIALIZER_UNLOCKED;
+
+static DRAM_ATTR uint8_t buffers[3][DMX_RX_PACKET_MAX];
+static DRAM_ATTR uint16_t sizes[3] = {};
+static DRAM_ATTR uint8_t filling = 0;      // written by the interrupt
+static DRAM_ATTR uint8_t ready = 1;        // latest complete frame
+static uint8_t reading = 2;                // owned by receive()/read()
+static DRAM_ATTR uint16_t received = 0;    // bytes in the filling buffer
+static DRAM_ATTR bool fresh = false;       // ready holds a frame not yet taken
+static DRAM_ATTR bool dropped = false;     // the filling frame lost bytes to an overflow
+static volatile uint32_t frameMillis = 0;
+
+static DRAM_ATTR DmxRxStats counters = {};
+static DRAM_ATTR uint32_t breakMicros = 0;   // when the last break was reported
+static DRAM_ATTR uint8_t inputPin = 0;
+
+static void IRAM_ATTR drainFifo() {
+  uint32_t length = uart_ll_get_rxfifo_len(rxUart);
+  while (length--) {
+    uint8_t byte;
+    uart_ll_read_rxfifo(rxUart, &byte, 1);
+    if (received < DMX_RX_PACKET_MAX) { buffers[filling][received] = byte; }
+    if (received <= DMX_RX_PACKET_MAX + 1) { received++; }   // the break byte, then one more marks an overlong frame
+  }
+}
+
+// The rising edge that ends a break; armed by the UART interrupt for this one edge.
+static void IRAM_ATTR onBreakEnd(void *) {
+  gpio_ll_set_intr_type(&GPIO, inputPin, GPIO_INTR_DISABLE);
+  uint32_t length = micros() - breakMicros + DMX_RX_BREAK_DETECT;
+  counters.lastBreak = length > UINT16_MAX ? UINT16_MAX : length;
+  if (length < DMX_RX_BREAK_MIN) { counters.shortBreaks++; }
+  else if (length > DMX_RX_BREAK_LONG) { counters.longBreaks++; }
+}
+
+static void IRAM_ATTR onBreak() {
+  uint32_t now = micros();
+  if (breakMicros) {
+    uint32_t interval = now - breakMicros;
+    int8_t bucket = interval ? 32 - __builtin_clz(interval) - DMX_RX_INTERVAL_MIN : 0;
+    if (bucket < 0) { bucket = 0; }
+    if (bucket >= DMX_RX_INTERVAL_BUCKETS) { bucket = DMX_RX_INTERVAL_BUCKETS - 1; }
+    counters.intervals[bucket]++;
+  }
+  breakMicros = now;
+  // Already high: the break ended within the detection time, well under the minimum.
+  if (gpio_ll_get_level(&GPIO, inputPin)) {
+    counters.lastBreak = DMX_RX_BREAK_DETECT;
+    counters.shortBreaks++;
+  } else {
+    gpio_ll_set_intr_type(&GPIO, inputPin, GPIO_INTR_POSEDGE);
+  }
+}
+
+static void IRAM_ATTR publishFrame(uint16_t size) {
+  portENTER_CRITICAL_ISR(&rxMux);
+  sizes[filling] = size;
+  uint8_t done = filling;
+  filling = ready;
+  ready = done;
+  fresh = true;
+  counters.frames++;
+  if (counters.lastSize && size != counters.lastSize) { counters.sizeChanges++; }
+  counters.lastSize = size;
+  portEXIT_CRITICAL_ISR(&rxMux);
+  frameMillis = millis();
+}
+
+static void IRAM_ATTR onRxInterrupt(void *) {
+  uint32_t status = uart_ll_get_intsts_mask(rxUart);
+  if (status & UART_INTR_RXFIFO_OVF) {
+    uart_ll_rxfifo_rst(rxUart);
+    dropped = true;
+    counters.overruns++;
+  } else {
+    drainFifo();
+  }
+  // A break also raises a framing error; only the ones without count.
+  if ((status & (UART_INTR_FRAM_ERR | UART_INTR_BRK_DET)) == UART_INTR_FRAM_ERR) { counters.framingErrors++; }
+
+  if (status & UART_INTR_BRK_DET) {
+    onBreak();
+    // The break itself arrives as a 0 byte with a framing error; it is not part of either frame.
+    uint16_t size = received > 0 ? received - 1 : 0;
+    if (dropped || size == 0) {}
+    else if (size > DMX_RX_PACKET_MAX) { counters.oversize++; }
+    else if (buffers[filling][0] != 0) { counters.otherStartCodes++; }
+    else { publishFrame(size); }
+    received = 0;
+    dropped = false;
+  }
+  uart_ll_clr_intsts_mask(rxUart, status);
+}
+
+// Runs on core 0 so the interrupt is serviced there.
+static void installInterrupt(void *) {
+  esp_intr_alloc(ETS_UART1_INTR_SOURCE, ESP_INTR_FLAG_IRAM, onRxInterrupt, nullptr, &rxInterrupt);
+  gpio_install_isr_service(ESP_INTR_FLAG_IRAM);   // may already be installed
+  gpio_set_intr_type((gpio_num_t)inputPin, GPIO_INTR_DISABLE);
+  gpio_isr_handler_add((gpio_num_t)inputPin, onBreakEnd, nullptr);
+}
+
+void DmxRxEngine::begin(int pin) {
+  periph_module_enable(PERIPH_UART1_MODULE);
+  uart_ll_set_sclk(rxUart, UART_SCLK_APB);
+  uart_ll_set_baudrate(rxUart, DMX_BAUD);
+  uart_ll_set_data_bit_num(rxUart, UART_DATA_8_BITS);
+  uart_ll_set_parity(rxUart, UART_PARITY_DISABLE);
+  uart_ll_set_stop_bits(rxUart, UART_STOP_BITS_2);
+  uart_ll_set_rxfifo_full_thr(rxUart, DMX_RX_FIFO_TRIGGER);
+  uart_ll_set_rx_tout(rxUart, 10);   // drain a frame's tail when the line goes quiet
+  uart_ll_rxfifo_rst(rxUart);
+
+  pinMode(pin, INPUT_PULLUP);
+  pinMatrixInAttach(pin, U1RXD_IN_IDX, false);
+  inputPin = pin;
+
+  uart_ll_disable_intr_mask(rxUart, UART_LL_INTR_MASK);
+  uart_ll_clr_intsts_mask(rxUart, UART_LL_INTR_MASK);
+  esp_ipc_call_blocking(0, installInterrupt, nullptr);
+  uart_ll_ena_intr_mask(rxUart, DMX_RX_INTERRUPTS);
+}
+
+bool DmxRxEngine::receive() {
+  bool taken = false;
+  portENTER_CRITICAL(&rxMux);
+  if (fresh) {
+    uint8_t done = ready;
+    ready = reading;
+    reading = done;
+    fresh = false;
+    taken = true;
+  }
+  portEXIT_CRITICAL(&rxMux);
+  return taken;
+}
+
+uint8_t DmxRxEngine::read(uint16_t slot) const {
+  return slot < sizes[reading] ? buffers[reading][slot] : 0;
+}
+
+uint16_t DmxRxEngine::size() const {
+  return sizes[reading];
+}
+
+uint32_t DmxRxEngine::frames() const {
+  return counters.frames;
+}
+
+uint32_t DmxRxEngine::lastFrameMillis() const {
+  return frameMillis;
+}
+
+void DmxRxEngine::stats(DmxRxStats &out) const {
+  portENTER_CRITICAL(&rxMux);
+  out = counters;
+  portEXIT_CRITICAL(&rxMux);
+}
+
+void DmxRxEngine::resetStats() {
+  portENTER_CRITICAL(&rxMux);
+  counters = {};
+  portEXIT_CRITICAL(&rxMux);
+}
@@ -0,0 +1,80 @@
+/******************************************************************************
+DmxRx.h
+UART receive engine, independent of the transmit side: it runs on UART1
+(transmit uses UART2) with its own buffers, so one controller can listen
+to a console universe while it drives another.
+
+Frames are delimited by the UART's break detection and collected by a
+short IRAM interrupt that only drains the RX FIFO, at most 128 bytes per
+call, and swaps buffers under a spinlock held for a few instructions. The
+interrupt is allocated on core 0, away from the loop task and the UART2
+driver on core 1, so transmitting never delays it.
+
+Only level data (start code 0) is kept. Completed frames are
+triple-buffered: the interrupt fills one buffer, the latest complete frame
+waits in a second, and receive() swaps it into the third for reading, so a
+reader never sees a frame being written.
+
+Signal quality is counted in the same interrupts at a few cycles per
+event: framing errors, FIFO overruns, breaks shorter than the 88 us
+minimum or longer than DMX_RX_BREAK_LONG, slot-count changes and a
+power-of-two histogram of the intervals between breaks. A break's length
+is taken from its detection to the rising edge that ends it, caught by a
+GPIO interrupt armed for that one edge.
+
+The SparkFun shield's transceiver is half duplex; receiving while
+transmitting needs a second RS-485 receiver on its own pin.
+
+This code is released under the [MIT License](http://opensource.org/licenses/MIT).
+******************************************************************************/
+
+#include <inttypes.h>
+
+#ifndef DmxRx_h
+#define DmxRx_h
+
+#define DMX_RX_PACKET_MAX    513   // start code and 512 slots
+#define DMX_RX_FIFO_TRIGGER  32    // bytes buffered in the FIFO before the interrupt drains it
+#define DMX_RX_BREAK_MIN     88    // us, shorter breaks are out of spec
+#define DMX_RX_BREAK_LONG    1000  // us, longer breaks are counted as long
+#define DMX_RX_BREAK_DETECT  44    // us of break already passed when the UART reports it
+#define DMX_RX_INTERVAL_MIN  10    // first histogram bucket: intervals below 2^10 us (~1 ms)
+#define DMX_RX_INTERVAL_BUCKETS 12 // then one bucket per doubling; the last collects the rest
+
+struct DmxRxStats {
+  uint32_t frames;          // start code 0 frames published
+  uint32_t otherStartCodes; // complete frames with another start code (RDM, text, ...)
+  uint32_t oversize;        // frames longer than 513 bytes
+  uint32_t framingErrors;   // bad stop bits outside a break
+  uint32_t overruns;        // RX FIFO overflows; the frame is dropped
+  uint32_t shortBreaks;
+  uint32_t longBreaks;
+  uint32_t sizeChanges;     // published frames whose size differs from the previous one
+  uint16_t lastBreak;       // us
+  uint16_t lastSize;
+  uint32_t intervals[DMX_RX_INTERVAL_BUCKETS];   // break to break, bucket n < 2^(DMX_RX_INTERVAL_MIN + n) us
+};
+
+class DmxRxEngine {
+public:
+  // Starts receiving on pin.
+  void begin(int pin);
+  // Takes the latest complete frame, if one arrived since the last call. Returns true if so.
+  bool receive();
+  // Slot of the frame last taken by receive(); 0 is the start code.
+  uint8_t read(uint16_t slot) const;
+  // Bytes in that frame, start code included; 0 before the first frame.
+  uint16_t size() const;
+  uint32_t frames() const;
+  // millis() when the last complete frame arrived.
+  uint32_t lastFrameMillis() const;
+  // Copy of the signal-quality counters. The interrupts don't lock for
+  // single increments, so an event landing mid-copy may show in one
+  // counter before another.
+  void stats(DmxRxStats &out) const;
+  void resetStats();
+};
+
+extern DmxRxEngine dmxRx;
+
+#endif
@@ -0,0 +1,42 @@
+/******************************************************************************
+DmxUart.cpp
+UART transmit engine shared by SparkFunDMX and every DmxUniverse<Slots>.
+
+This code is released under the [MIT License](http://opensource.org/licenses/MIT).
+******************************************************************************/
+
+#include <Arduino.h>
+#include <HardwareSerial.h>
+
+#include "DmxUart.h"
+
+#define DMXFORMAT      SERIAL_8N2
+
+int enablePin = 21;		//dafault on ESP32
+int rxPin = 16;
+int txPin = 17;
+
+HardwareSerial DMXSerial(2);
+
+DmxUartEngine dmxUart;
+
+void DmxUartEngine::beginWrite() {
+  DMXSerial.begin(DMX_BAUD, DMXFORMAT, rxPin, txPin);
+  pinMode(enablePin, OUTPUT);
+  digitalWrite(enablePin, HIGH);
+}
+
+void DmxUartEngine::send(const uint8_t *packet, uint16_t size) {
+  // The port stays open from beginWrite(): begin()/end() per packet would
+  // install and delete the UART driver, allocating on every frame.
+  pinMatrixOutDetach(txPin, false, false); //Detach our
+  pinMode(txPin, OUTPUT);
+  digitalWrite(txPin, LOW); //88 uS break
+  delayMicroseconds(DMX_BREAK_MICROS);
+  digitalWrite(txPin, HIGH); //Mark After Break
+  delayMicroseconds(DMX_MAB_MICROS);
+  pinMatrixOutAttach(txPin, U2TXD_OUT_IDX, false, false);
+
+  DMXSerial.write(packet, size);
+  DMXSerial.flush();
+}
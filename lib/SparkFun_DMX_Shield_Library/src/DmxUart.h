@@ -0,0 +1,32 @@
+/******************************************************************************
+DmxUart.h
+UART transmit engine shared by SparkFunDMX and every DmxUniverse<Slots>.
+
+Generates break and mark-after-break on the TX pin, then sends a packet
+(start code followed by the slots) at 250 kbaud, 8N2. It holds no packet
+buffer of its own, so one engine serves buffers of any size.
+
+This code is released under the [MIT License](http://opensource.org/licenses/MIT).
+******************************************************************************/
+
+#include <inttypes.h>
+
+#ifndef DmxUart_h
+#define DmxUart_h
+
+#define DMX_BAUD            250000
+#define DMX_BREAK_MICROS    88       // minimum break
+#define DMX_MAB_MICROS      12       // mark after break, 8 us minimum
+#define DMX_SLOT_MICROS     44       // start + 8 data + 2 stop bits at 4 us
+
+class DmxUartEngine {
+public:
+  // Opens the port once; it stays open between packets.
+  void beginWrite();
+  // Sends break, MAB and size bytes of packet. Blocks until the last byte is out.
+  void send(const uint8_t *packet, uint16_t size);
+};
+
+extern DmxUartEngine dmxUart;
+
+#endif
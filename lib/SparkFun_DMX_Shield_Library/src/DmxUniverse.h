@@ -0,0 +1,54 @@
+/******************************************************************************
+DmxUniverse.h
+Fixed-size DMX output universe.
+
+A DmxUniverse<Slots> owns exactly Slots + 1 bytes (start code and slots)
+and computes its packet size and frame time at compile time. All sizes
+share the non-template DmxUartEngine, so each extra universe costs its
+buffer and a few inlined lines, not another copy of the driver.
+
+This code is released under the [MIT License](http://opensource.org/licenses/MIT).
+******************************************************************************/
+
+#include <inttypes.h>
+#include <string.h>
+#include "DmxUart.h"
+
+#ifndef DmxUniverse_h
+#define DmxUniverse_h
+
+template <uint16_t Slots>
+class DmxUniverse {
+  static_assert(Slots >= 1 && Slots <= 512, "a DMX universe has 1 to 512 slots");
+
+public:
+  static constexpr uint16_t slots = Slots;
+  static constexpr uint16_t packetSize = Slots + 1;   // start code included
+  static constexpr uint32_t frameMicros = DMX_BREAK_MICROS + DMX_MAB_MICROS + (uint32_t)packetSize * DMX_SLOT_MICROS;
+  static constexpr uint32_t maxRefreshHz = 1000000 / frameMicros;
+
+  void begin() { dmxUart.beginWrite(); }
+
+  // Channels are 1..Slots; out of range writes are ignored.
+  void write(uint16_t channel, uint8_t value) {
+    if (channel >= 1 && channel <= Slots) { data[channel] = value; }
+  }
+
+  void write(uint16_t startChannel, const uint8_t *values, uint16_t count) {
+    if (startChannel < 1 || startChannel > Slots) { return; }
+    if (count > Slots + 1 - startChannel) { count = Slots + 1 - startChannel; }
+    memcpy(&data[startChannel], values, count);
+  }
+
+  uint8_t read(uint16_t channel) const { return channel <= Slots ? data[channel] : 0; }
+
+  void update() { dmxUart.send(data, packetSize); }
+
+  // The packet as sent, start code first.
+  const uint8_t *packet() const { return data; }
+
+protected:
+  uint8_t data[packetSize] = {};   // data[0] is the start code, always 0
+};
+
+#endif
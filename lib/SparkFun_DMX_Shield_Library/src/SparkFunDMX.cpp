@@ -17,91 +17,54 @@ Distributed as-is; no warranty is given.
 #include <Arduino.h>
 
 #include "SparkFunDMX.h"
-#include <HardwareSerial.h>
+#include "DmxUart.h"
+#include "DmxRx.h"
 
 #define dmxMaxChannel  513
 #define defaultMax 32
 
-#define DMXSPEED       250000
-#define DMXFORMAT      SERIAL_8N2
+// Pins are shared with the transmit engine in DmxUart.cpp.
+extern int enablePin;
+extern int rxPin;
 
-int enablePin = 21;		//dafault on ESP32
-int rxPin = 16;
-int txPin = 17;
-
-//DMX value array and size. Entry 0 will hold startbyte
+//DMX output array and size. Entry 0 will hold startbyte
 uint8_t dmxData[dmxMaxChannel] = {};
 int chanSize;
-int currentChannel = 0;
-
-HardwareSerial DMXSerial(2);
-
-/* Interrupt Timer for DMX Receive */
-hw_timer_t * timer = NULL;
-portMUX_TYPE timerMux = portMUX_INITIALIZER_UNLOCKED;
-
-volatile int _interruptCounter;
-volatile bool _startCodeDetected = false;
-
-volatile bool ledPin = false;
-
-/* Start Code is detected by 21 low interrupts */
-void IRAM_ATTR onTimer() {
-	if (digitalRead(rxPin) == 1)
-	{
-		_interruptCounter = 0; //If the RX Pin is high, we are not in an interrupt
-	}
-	else
-	{
-		_interruptCounter++;
-	}
-	if (_interruptCounter > 9)
-	{	
-		portENTER_CRITICAL_ISR(&timerMux);
-		_startCodeDetected = true;
-		DMXSerial.begin(DMXSPEED, DMXFORMAT, rxPin, txPin);
-		portEXIT_CRITICAL_ISR(&timerMux);
-		_interruptCounter = 0;
-	}
-}
+int readSize;
 
-void SparkFunDMX::initRead(int chanQuant) {
-	
-  timer = timerBegin(0, 1, true);
-  timerAttachInterrupt(timer, &onTimer, true);
-  timerAlarmWrite(timer, 320, true);
-  timerAlarmEnable(timer);
-  _READWRITE = _READ;
+void SparkFunDMX::initRead(int chanQuant, int pin) {
   if (chanQuant > dmxMaxChannel || chanQuant <= 0) 
   {
     chanQuant = defaultMax;
   }
-  chanSize = chanQuant;
-  pinMode(13, OUTPUT);
-  pinMode(enablePin, OUTPUT);
-  digitalWrite(enablePin, LOW);
-  pinMode(rxPin, INPUT);
+  readSize = chanQuant;
+  if (pin < 0) pin = rxPin;
+  if (pin == rxPin && !_writing) //The shield's transceiver faces one way at a time
+  {
+    pinMode(enablePin, OUTPUT);
+    digitalWrite(enablePin, LOW);
+  }
+  dmxRx.begin(pin);
+  _reading = true;
 }
 
 // Set up the DMX-Protocol
 void SparkFunDMX::initWrite (int chanQuant) {
 
-  _READWRITE = _WRITE;
   if (chanQuant > dmxMaxChannel || chanQuant <= 0) {
     chanQuant = defaultMax;
   }
 
   chanSize = chanQuant + 1; //Add 1 for start code
 
-  DMXSerial.begin(DMXSPEED, DMXFORMAT, rxPin, txPin);
-  pinMode(enablePin, OUTPUT);
-  digitalWrite(enablePin, HIGH);
+  dmxUart.beginWrite();
+  _writing = true;
 }
 
-// Function to read DMX data
+// Function to read DMX data from the last frame taken by update()
 uint8_t SparkFunDMX::read(int Channel) {
-  if (Channel > chanSize) Channel = chanSize;
-  return(dmxData[Channel - 1]); //subtract one to account for start byte
+  if (Channel < 1 || Channel > readSize) return 0;
+  return dmxRx.read(Channel); //slot 0 is the start code
 }
 
 // Function to send DMX data
@@ -113,43 +76,24 @@ void SparkFunDMX::write(int Channel, uint8_t value) {
 }
 
 
+// Function to send a block of DMX data starting at startChannel
+void SparkFunDMX::write(int startChannel, const uint8_t *values, int count) {
+  if (startChannel < 1) startChannel = 1;
+  if (startChannel + count > dmxMaxChannel) count = dmxMaxChannel - startChannel;
+  if (count <= 0) return;
+  if (startChannel + count > chanSize) chanSize = startChannel + count; // slots sent include the start code
+  dmxData[0] = 0;
+  memcpy(&dmxData[startChannel], values, count);
+}
 
+// Function to update the DMX bus
 void SparkFunDMX::update() {
-  if (_READWRITE == _WRITE)
+  if (_reading)
   {
-	DMXSerial.begin(DMXSPEED, DMXFORMAT, rxPin, txPin);//Begin the Serial port
-    pinMatrixOutDetach(txPin, false, false); //Detach our
-    pinMode(txPin, OUTPUT); 
-    digitalWrite(txPin, LOW); //88 uS break
-    delayMicroseconds(88);  
-    digitalWrite(txPin, HIGH); //4 Us Mark After Break
-    delayMicroseconds(1);
-    pinMatrixOutAttach(txPin, U2TXD_OUT_IDX, false, false);
-
-    DMXSerial.write(dmxData, chanSize);
-    DMXSerial.flush();
-    DMXSerial.end();//clear our DMX array, end the Hardware Serial port
+    dmxRx.receive(); //Frames are collected by the receive interrupt; this only takes the newest
   }
-  else if (_READWRITE == _READ)//In a perfect world, this function ends serial communication upon packet completion and attaches RX to a CHANGE interrupt so the start code can be read again
-  { 
-	if (_startCodeDetected == true)
-	{
-		while (DMXSerial.available())
-		{
-			dmxData[currentChannel++] = DMXSerial.read();
-		}
-	if (currentChannel > chanSize) //Set the channel counter back to 0 if we reach the known end size of our packet
-	{
-		
-      portENTER_CRITICAL(&timerMux);
-	  _startCodeDetected = false;
-	  DMXSerial.flush();
-	  DMXSerial.end();
-      portEXIT_CRITICAL(&timerMux);
-	  currentChannel = 0;
-	}
-	}
+  if (_writing)
+  {
+    dmxUart.send(dmxData, chanSize);
   }
 }
-
-// Function to update the DMX bus
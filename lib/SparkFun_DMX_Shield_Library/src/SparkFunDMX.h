@@ -21,18 +21,21 @@ Distributed as-is; no warranty is given.
 
 // ---- Methods ----
 
+// Reading and writing are independent and may both be started: input and
+// output have separate buffers and engines (DmxRx on UART1, DmxUart on UART2).
 class SparkFunDMX {
 public:
-  void initRead(int maxChan);
+  // pin defaults to the shield's RX pin; full duplex needs a second receiver on another pin.
+  void initRead(int maxChan, int pin = -1);
   void initWrite(int maxChan);
   uint8_t read(int Channel);
   void write(int channel, uint8_t value);
+  void write(int startChannel, const uint8_t *values, int count);
+  // Sends the output frame when writing and takes the latest input frame when reading.
   void update();
 private:
-  uint8_t _startCodeValue = 0xFF;
-  bool _READ = true;
-  bool _WRITE = false;
-  bool _READWRITE;
+  bool _reading = false;
+  bool _writing = false;
 };
 
 #endif
\ No newline at end of file
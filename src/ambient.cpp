@@ -0,0 +1,96 @@
+#include <Arduino.h>
+#include <driver/adc.h>
+#include <atomic>
+
+#include "config.h"
+#include "ambient.h"
+#include "stats.h"
+
+#define AMBIENT_FRAME_SAMPLES 256   // conversions per DMA frame
+
+namespace {
+
+std::atomic<uint16_t> brightness{256};
+std::atomic<uint16_t> reading{0};   // filtered 12-bit reading
+
+uint16_t scaleFor(uint16_t raw) {
+  if (raw <= AMBIENT_DARK) { return AMBIENT_MIN_SCALE; }
+  if (raw >= AMBIENT_BRIGHT) { return 256; }
+  return AMBIENT_MIN_SCALE + (uint32_t)(raw - AMBIENT_DARK) * (256 - AMBIENT_MIN_SCALE) / (AMBIENT_BRIGHT - AMBIENT_DARK);
+}
+
+/**
+ * Each DMA frame is averaged into one sample, which feeds an exponential
+ * filter with a time constant of 2^AMBIENT_SMOOTHING frames. The scale is
+ * published only when it moves by AMBIENT_HYSTERESIS, so a flickering
+ * light source doesn't make the output stage rescale every frame.
+ */
+void ambientLoop(void *) {
+  adc_digi_output_data_t samples[AMBIENT_FRAME_SAMPLES];
+  uint32_t filtered = 0;   // reading << AMBIENT_SMOOTHING
+  bool primed = false;
+  for (;;) {
+    uint32_t bytes = 0;
+    if (adc_digi_read_bytes((uint8_t *)samples, sizeof(samples), &bytes, portMAX_DELAY) != ESP_OK) { continue; }
+    uint32_t count = bytes / sizeof(samples[0]);
+    if (count == 0) { continue; }
+
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < count; i++) { sum += samples[i].type1.data; }
+    uint32_t mean = sum / count;
+    filtered = primed ? filtered - (filtered >> AMBIENT_SMOOTHING) + mean : mean << AMBIENT_SMOOTHING;
+    primed = true;
+
+    uint16_t raw = filtered >> AMBIENT_SMOOTHING;
+    reading.store(raw, std::memory_order_relaxed);
+    uint16_t scale = scaleFor(raw);
+    uint16_t current = brightness.load(std::memory_order_relaxed);
+    if (scale + AMBIENT_HYSTERESIS <= current || scale >= current + AMBIENT_HYSTERESIS ||
+        (scale != current && (scale == 256 || scale == AMBIENT_MIN_SCALE))) {
+      brightness.store(scale, std::memory_order_relaxed);
+    }
+  }
+}
+
+}  // namespace
+
+void ambientBegin() {
+  if (!AMBIENT_ENABLE) { return; }
+
+  adc_digi_init_config_t init = {};
+  init.max_store_buf_size = 4 * AMBIENT_FRAME_SAMPLES * sizeof(adc_digi_output_data_t);
+  init.conv_num_each_intr = AMBIENT_FRAME_SAMPLES * sizeof(adc_digi_output_data_t);
+  init.adc1_chan_mask = BIT(AMBIENT_ADC_CHANNEL);
+  if (adc_digi_initialize(&init) != ESP_OK) { if (DEBUG) {Serial.println("Ambient: ADC init failed");} return; }
+
+  adc_digi_pattern_config_t pattern = {};
+  pattern.atten = ADC_ATTEN_DB_11;
+  pattern.channel = AMBIENT_ADC_CHANNEL;
+  pattern.unit = 0;   // ADC1; only ADC1 can run in DMA mode on the ESP32
+  pattern.bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+
+  adc_digi_configuration_t digi = {};
+  digi.conv_limit_en = true;
+  digi.conv_limit_num = 250;
+  digi.pattern_num = 1;
+  digi.adc_pattern = &pattern;
+  digi.sample_freq_hz = AMBIENT_SAMPLE_RATE;
+  digi.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+  digi.format = ADC_DIGI_OUTPUT_FORMAT_TYPE1;
+  adc_digi_controller_configure(&digi);
+  adc_digi_start();
+
+  TaskHandle_t task = nullptr;
+  xTaskCreatePinnedToCore(ambientLoop, "ambient", 3072, nullptr, 1, &task, 0);
+  statsRegisterTask(task);
+}
+
+uint16_t ambientBrightness() {
+  return brightness.load(std::memory_order_relaxed);
+}
+
+void reportAmbient() {
+  Serial.print("Ambient: reading "); Serial.print(reading.load(std::memory_order_relaxed));
+  Serial.print(", brightness "); Serial.print(ambientBrightness() * 100 / 256);
+  Serial.println(" %");
+}
@@ -0,0 +1,108 @@
+#include <Arduino.h>
+#include <array>
+
+#include "config.h"
+#include "attract.h"
+#include "easing.h"
+
+namespace {
+
+// ---- Lookup tables, built at compile time ----
+
+constexpr uint32_t hash(uint32_t x) {
+  x ^= x >> 16; x *= 0x7feb352d;
+  x ^= x >> 15; x *= 0x846ca68b;
+  x ^= x >> 16;
+  return x;
+}
+
+// Value-noise lattice: one random byte per lattice point, wrapping after 256.
+constexpr std::array<uint8_t, 256> buildNoise() {
+  std::array<uint8_t, 256> lut{};
+  for (uint32_t i = 0; i < 256; i++) { lut[i] = hash(i + 1) >> 24; }
+  return lut;
+}
+
+constexpr auto noiseLut = buildNoise();
+
+// Smooth noise at an 8.8 fixed-point lattice position.
+inline uint8_t noise(uint16_t position) {
+  uint8_t i = position >> 8;
+  uint8_t frac = position & 0xFF;
+  int16_t a = noiseLut[i];
+  int16_t b = noiseLut[(uint8_t)(i + 1)];
+  return a + ((b - a) * frac >> 8);
+}
+
+// ---- Hand-off state ----
+
+bool idleState = false;
+uint32_t switchMillis = 0;
+uint8_t gainAtSwitch = 0;
+
+uint8_t gain(uint32_t now) {
+  uint32_t elapsed = now - switchMillis;
+  uint16_t duration = idleState ? ATTRACT_FADE : ATTRACT_HANDOFF;
+  uint8_t target = idleState ? 255 : 0;
+  if (elapsed >= duration) { return target; }
+  return gainAtSwitch + ((int32_t)target - gainAtSwitch) * (int32_t)elapsed / duration;
+}
+
+// ---- CPU accounting ----
+
+uint32_t blendMicros = 0;    // attractLevels() alone
+uint32_t frameMicros = 0;    // the whole frame, output and recording included
+uint32_t renderFrames = 0;
+uint32_t windowMicros = 0;
+
+}  // namespace
+
+void attractSetIdle(bool idle, uint32_t now) {
+  if (!ATTRACT_ENABLE || idle == idleState) { return; }
+  gainAtSwitch = gain(now);
+  idleState = idle;
+  switchMillis = now;
+}
+
+bool attractActive(uint32_t now) {
+  return idleState || gain(now) > 0;
+}
+
+void attractLevels(uint32_t now, uint8_t *levels) {
+  uint32_t start = micros();
+  uint8_t g = gain(now);
+  if (g == 0) { return; }
+
+  // One breath per period: the bell curve, smoothstep up then down.
+  uint8_t breath = easeTables[CURVE_BELL][(now % ATTRACT_BREATH_PERIOD) * 256 / ATTRACT_BREATH_PERIOD];
+  int16_t base = ATTRACT_FLOOR + breath * ATTRACT_BREATH_DEPTH / 255;
+  uint16_t drift = now >> 2;   // one lattice point per ~1 s
+  for (uint8_t step = 1; step <= NUM_OF_STEPS; step++) {
+    int16_t shimmer = ((int16_t)noise(drift + step * 0x2F1B) - 128) * ATTRACT_SHIMMER_DEPTH / 128;
+    int16_t level = base + shimmer;
+    if (level < 0) { level = 0; }
+    level = level * g / 255;
+    if (level > levels[step]) { levels[step] = level; }
+  }
+
+  blendMicros += micros() - start;
+}
+
+void attractFrameDone(uint32_t start) {
+  if (renderFrames == 0) { windowMicros = start; }
+  frameMicros += micros() - start;
+  renderFrames++;
+}
+
+void reportAttract() {
+  uint32_t window = micros() - windowMicros;
+  Serial.print("Attract: "); Serial.print(renderFrames);
+  Serial.print(" frames, "); Serial.print(renderFrames ? frameMicros / renderFrames : 0);
+  Serial.print(" us/frame (glow "); Serial.print(renderFrames ? blendMicros / renderFrames : 0);
+  Serial.print(" us), CPU ");
+  Serial.print(window ? (uint32_t)((uint64_t)frameMicros * 10000 / window) / 100.0 : 0.0, 2);
+  Serial.println(" %");
+  blendMicros = 0;
+  frameMicros = 0;
+  renderFrames = 0;
+}
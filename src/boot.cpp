@@ -0,0 +1,61 @@
+#include <Arduino.h>
+#include <Preferences.h>
+
+#include "config.h"
+#include "output.h"
+#include "scenes.h"
+#include "boot.h"
+
+namespace {
+
+uint8_t bootScene = NO_SCENE;
+uint32_t firstFrameMicros = 0;
+uint32_t sceneFrameMicros = 0;
+bool resumed = false;
+
+}  // namespace
+
+void bootBegin(const WarmState *resume) {
+  outputBegin();
+
+  if (resume) {
+    resumed = true;
+    sceneCut(resume->scene);
+    for (uint8_t step = 1; step <= NUM_OF_STEPS; step++) { outputStep(step, resume->levels[step]); }
+    outputCommit();
+    firstFrameMicros = micros();
+    return;
+  }
+
+  // Blackout first: opening NVS can take tens of ms on a cold flash.
+  outputCommit();
+  firstFrameMicros = micros();
+
+  // Stored by name so it survives scenes being reordered in the show.
+  char name[32] = "";
+  Preferences prefs;
+  if (prefs.begin("boot", true)) {
+    prefs.getString("scene", name, sizeof(name));
+    prefs.end();
+  }
+  bootScene = sceneFind(name);
+  sceneCut(bootScene);
+  outputCommit();
+  sceneFrameMicros = micros();
+}
+
+void bootSetScene(uint8_t scene) {
+  Preferences prefs;
+  prefs.begin("boot", false);
+  if (scene < show::numScenes) { prefs.putString("scene", show::scenes[scene].name); }
+  else { prefs.remove("scene"); }
+  prefs.end();
+  bootScene = scene < show::numScenes ? scene : NO_SCENE;
+}
+
+void reportBoot() {
+  if (resumed) { Serial.println("Warm restart: resumed from RTC snapshot"); }
+  Serial.print("Boot scene: "); Serial.println(bootScene == NO_SCENE ? "blackout" : show::scenes[bootScene].name);
+  Serial.print("First frame after: "); Serial.print(firstFrameMicros); Serial.println(" us");
+  if (!resumed) { Serial.print("Boot scene after: "); Serial.print(sceneFrameMicros); Serial.println(" us"); }
+}
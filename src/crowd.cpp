@@ -0,0 +1,47 @@
+#include <Arduino.h>
+#include <math.h>
+
+#include "config.h"
+#include "crowd.h"
+
+namespace {
+
+float rate = 0;              // decayed trigger count at rateMillis
+uint32_t rateMillis = 0;
+uint32_t checkMillis = 0;
+bool crowd = false;
+
+// Brings the estimate forward to now.
+void decay(uint32_t now) {
+  rate *= expf(-(float)(now - rateMillis) / CROWD_TIME_CONSTANT);
+  rateMillis = now;
+}
+
+}  // namespace
+
+void crowdTrigger(uint32_t now) {
+  if (!CROWD_ENABLE) { return; }
+  decay(now);
+  rate += 1;
+}
+
+bool crowdUpdate(uint32_t now) {
+  if (!CROWD_ENABLE || now - checkMillis < CROWD_CHECK_INTERVAL) { return crowd; }
+  checkMillis = now;
+  decay(now);
+  bool next = crowd ? rate >= CROWD_EXIT_RATE : rate >= CROWD_ENTER_RATE;
+  if (next != crowd && DEBUG) {Serial.println(next ? "Crowd mode on" : "Crowd mode off");}
+  crowd = next;
+  return crowd;
+}
+
+bool crowdActive() {
+  return crowd;
+}
+
+void reportCrowd() {
+  decay(millis());
+  Serial.print("Crowd: "); Serial.print(rate, 1);
+  Serial.print(" triggers per "); Serial.print(CROWD_TIME_CONSTANT / 1000);
+  Serial.println(crowd ? " s, on" : " s, off");
+}
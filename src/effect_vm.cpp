@@ -0,0 +1,188 @@
+#include <Arduino.h>
+
+#include "config.h"
+#include "effect_vm.h"
+
+namespace {
+
+inline int32_t clampLevel(int32_t value) {
+  return value < 0 ? 0 : value > 255 ? 255 : value;
+}
+
+// ---- Builtin programs ----
+
+// A slow bright band travelling up the stairs, layered over the wave.
+const VmInstr ripple[] = {
+  {VM_STEP,   1, 0, 0},
+  {VM_LDI,    2, 16, 0},
+  {VM_MUL,    1, 1, 2},   // r1 = step * 16
+  {VM_TIME,   3, 0, 0},
+  {VM_LDI,    2, 3, 0},
+  {VM_SHR,    3, 3, 2},   // r3 = t / 8
+  {VM_SUB,    3, 3, 1},
+  {VM_LDI,    2, 255, 0},
+  {VM_AND,    3, 3, 2},   // r3 = (t / 8 - step * 16) & 255
+  {VM_EASE,   3, 3, CURVE_BELL},
+  {VM_LDI,    2, 2, 0},
+  {VM_SHR,    3, 3, 2},   // band peaks at a quarter level
+  {VM_LEVEL,  4, 0, 0},
+  {VM_MAX,    4, 4, 3},
+  {VM_OUT,    4, 0, 0},
+};
+
+// Whole staircase breathing between the wave level and a dim floor.
+const VmInstr breathe[] = {
+  {VM_TIME,   1, 0, 0},
+  {VM_LDI,    2, 4, 0},
+  {VM_SHR,    1, 1, 2},   // r1 = t / 16
+  {VM_LDI,    2, 255, 0},
+  {VM_AND,    1, 1, 2},
+  {VM_EASE,   1, 1, CURVE_BELL},
+  {VM_LDI,    2, 3, 0},
+  {VM_SHR,    1, 1, 2},   // 0..31
+  {VM_LEVEL,  3, 0, 0},
+  {VM_MAX,    3, 3, 1},
+  {VM_OUT,    3, 0, 0},
+};
+
+// ---- Loaded program ----
+
+VmInstr program[VM_MAX_PROGRAM + 1];   // + implicit VM_END
+uint8_t programLength = 0;
+uint32_t programMillis = 0;
+uint32_t budgetOverruns = 0;
+
+bool validRegisters(const VmInstr &i, bool a, bool b) {
+  return i.d < VM_REGISTERS && (!a || i.a < VM_REGISTERS) && (!b || i.b < VM_REGISTERS);
+}
+
+bool validInstr(const VmInstr &i, uint8_t pc, uint8_t length) {
+  switch (i.op) {
+    case VM_END:
+      return true;
+    case VM_LDI: case VM_STEP: case VM_COUNT: case VM_TIME: case VM_LEVEL: case VM_OUT:
+      return validRegisters(i, false, false);
+    case VM_MOV:
+      return validRegisters(i, true, false);
+    case VM_EASE:
+      return validRegisters(i, true, false) && i.b < NUM_EASE_CURVES;
+    case VM_SKIPLT:
+      return validRegisters(i, true, true) && pc + 1 + i.d <= length;
+    default:
+      return i.op < VM_NUM_OPS && validRegisters(i, true, true);
+  }
+}
+
+int8_t hexDigit(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+}  // namespace
+
+const VmProgram vmBuiltins[] = {
+  {"ripple",  ripple,  sizeof(ripple) / sizeof(VmInstr)},
+  {"breathe", breathe, sizeof(breathe) / sizeof(VmInstr)},
+};
+const uint8_t vmNumBuiltins = sizeof(vmBuiltins) / sizeof(VmProgram);
+
+bool vmLoad(const VmInstr *code, uint8_t length) {
+  if (length == 0 || length > VM_MAX_PROGRAM) { return false; }
+  for (uint8_t pc = 0; pc < length; pc++) {
+    if (!validInstr(code[pc], pc, length)) { return false; }
+  }
+  memcpy(program, code, length * sizeof(VmInstr));
+  program[length] = {VM_END, 0, 0, 0};
+  programLength = length;
+  programMillis = millis();
+  return true;
+}
+
+bool vmLoadText(const char *text) {
+  for (uint8_t i = 0; i < vmNumBuiltins; i++) {
+    if (strcmp(text, vmBuiltins[i].name) == 0) { return vmLoad(vmBuiltins[i].code, vmBuiltins[i].length); }
+  }
+
+  VmInstr code[VM_MAX_PROGRAM];
+  uint8_t *bytes = (uint8_t *)code;
+  size_t count = 0;
+  for (const char *c = text; *c; c++) {
+    if (*c == ' ') { continue; }
+    int8_t high = hexDigit(c[0]);
+    int8_t low = c[1] ? hexDigit(c[1]) : -1;
+    if (high < 0 || low < 0 || count >= sizeof(code)) { return false; }
+    bytes[count++] = high << 4 | low;
+    c++;
+  }
+  if (count % sizeof(VmInstr) != 0) { return false; }
+  return vmLoad(code, count / sizeof(VmInstr));
+}
+
+void vmUnload() {
+  programLength = 0;
+}
+
+bool vmActive() {
+  return programLength > 0;
+}
+
+uint32_t vmRun(uint8_t *levels) {
+  uint32_t now = millis() - programMillis;
+  uint32_t executed = 0;
+  int32_t r[VM_REGISTERS];
+
+  for (uint8_t step = 1; step <= NUM_OF_STEPS; step++) {
+    if (executed + programLength > VM_FRAME_BUDGET) {
+      budgetOverruns++;   // remaining steps keep their rendered level this frame
+      break;
+    }
+    memset(r, 0, sizeof(r));
+    const VmInstr *pc = program;
+    for (;;) {
+      const VmInstr &i = *pc++;
+      executed++;
+      switch (i.op) {
+        case VM_LDI:    r[i.d] = (int16_t)(i.a | i.b << 8); continue;
+        case VM_MOV:    r[i.d] = r[i.a]; continue;
+        case VM_STEP:   r[i.d] = step; continue;
+        case VM_COUNT:  r[i.d] = NUM_OF_STEPS; continue;
+        case VM_TIME:   r[i.d] = now; continue;
+        case VM_LEVEL:  r[i.d] = levels[step]; continue;
+        case VM_ADD:    r[i.d] = (uint32_t)r[i.a] + (uint32_t)r[i.b]; continue;
+        case VM_SUB:    r[i.d] = (uint32_t)r[i.a] - (uint32_t)r[i.b]; continue;
+        case VM_MUL:    r[i.d] = (uint32_t)r[i.a] * (uint32_t)r[i.b]; continue;
+        case VM_DIV:    r[i.d] = r[i.b] == 0 ? 0 : r[i.b] == -1 ? 0u - (uint32_t)r[i.a] : r[i.a] / r[i.b]; continue;
+        case VM_AND:    r[i.d] = r[i.a] & r[i.b]; continue;
+        case VM_SHR:    r[i.d] = r[i.a] >> (r[i.b] & 31); continue;
+        case VM_MIN:    r[i.d] = r[i.a] < r[i.b] ? r[i.a] : r[i.b]; continue;
+        case VM_MAX:    r[i.d] = r[i.a] > r[i.b] ? r[i.a] : r[i.b]; continue;
+        case VM_EASE:   r[i.d] = easeTables[i.b][clampLevel(r[i.a])]; continue;
+        case VM_BLEND:  r[i.d] = r[i.a] + ((int64_t)r[i.b] - r[i.a]) * clampLevel(r[i.d]) / 255; continue;
+        case VM_SKIPLT: if (r[i.a] < r[i.b]) { pc += i.d; } continue;
+        case VM_OUT:    levels[step] = clampLevel(r[i.d]); break;
+        default:        break;   // VM_END
+      }
+      break;
+    }
+  }
+  return executed;
+}
+
+void vmBenchmark() {
+  bool loaded = vmActive();
+  if (!loaded) { vmLoad(vmBuiltins[0].code, vmBuiltins[0].length); }
+
+  uint8_t levels[NUM_OF_STEPS + 1] = {};
+  uint32_t executed = 0;
+  uint32_t start = micros();
+  for (uint16_t frame = 0; frame < 1000; frame++) { executed += vmRun(levels); }
+  uint32_t elapsed = micros() - start;
+  if (!loaded) { vmUnload(); }
+
+  Serial.print("VM: "); Serial.print(executed);
+  Serial.print(" instructions in "); Serial.print(elapsed);
+  Serial.print(" us, "); Serial.print(elapsed ? (uint32_t)((uint64_t)executed * 1000000 / elapsed) : 0);
+  Serial.print(" instr/s, budget overruns "); Serial.println(budgetOverruns);
+}
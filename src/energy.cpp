@@ -0,0 +1,147 @@
+#include <Arduino.h>
+#include <Preferences.h>
+#include <rom/crc.h>
+#include <array>
+
+#include "config.h"
+#include "energy.h"
+#include "stats.h"
+
+#define MS_PER_MWH 3600000ULL
+
+namespace {
+
+// Persisted totals, one entry per step; entry 0 collects channels outside the step patch.
+struct EnergyCheckpoint {
+  uint32_t sequence;
+  uint32_t milliwattHours[NUM_OF_STEPS + 1];
+  uint32_t onSeconds[NUM_OF_STEPS + 1];
+  uint32_t crc;
+};
+
+struct StepMeter {
+  uint64_t milliwattMillis;   // energy since boot plus the checkpoint loaded at boot
+  uint64_t onMillis;
+  uint32_t loadMilliwatts;    // current estimated draw
+  uint32_t chargedMillis;     // when the step was last charged
+  uint16_t litChannels;       // channels above 0
+};
+
+// Built at compile time: the boot frame is charged before energyBegin() runs.
+constexpr std::array<uint8_t, show::dmxSlots + 1> buildChannelStep() {
+  std::array<uint8_t, show::dmxSlots + 1> map{};
+  for (uint8_t step = 1; step <= NUM_OF_STEPS; step++) {
+    for (uint16_t c = 0; c < show::footprint; c++) { map[show::patch[step - 1] + c] = step; }
+  }
+  return map;
+}
+
+StepMeter meters[NUM_OF_STEPS + 1] = {};
+constexpr auto channelStep = buildChannelStep();
+
+EnergyCheckpoint snapshot;
+uint32_t sequence = 0;
+uint32_t checkpointMillis = 0;
+TaskHandle_t checkpointTask = nullptr;
+volatile bool checkpointBusy = false;
+
+inline uint32_t channelLoad(uint16_t channel, uint8_t value) {
+  return (uint32_t)value * show::channelMilliwatts[channel] / 255;
+}
+
+uint32_t checkpointCrc(const EnergyCheckpoint &c) {
+  return crc32_le(0, (const uint8_t *)&c, offsetof(EnergyCheckpoint, crc));
+}
+
+void ringKey(uint32_t seq, char *key) {
+  snprintf(key, 4, "e%u", (unsigned)(seq % ENERGY_RING_SLOTS));
+}
+
+// Brings a step's integrators up to now at its current load.
+void chargeStep(StepMeter &m, uint32_t now) {
+  uint32_t elapsed = now - m.chargedMillis;
+  m.milliwattMillis += (uint64_t)m.loadMilliwatts * elapsed;
+  if (m.litChannels) { m.onMillis += elapsed; }
+  m.chargedMillis = now;
+}
+
+// Writes each snapshot to the next key of the ring, off the DMX loop. The
+// namespace stays open so a checkpoint doesn't allocate a new NVS handle.
+// The flash write still disables the cache on both cores, so the loop on
+// core 1 halts for it: about 1 ms per checkpoint, plus a 4 KB sector erase
+// (typically 45 ms) whenever NVS starts a fresh page. energyCheckpoint() only
+// hands over snapshots while the stairs are idle, so the stall lands on an
+// attract frame instead of a walker's wave.
+void checkpointLoop(void *) {
+  Preferences prefs;
+  prefs.begin("energy", false);
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    char key[4];
+    ringKey(snapshot.sequence, key);
+    prefs.putBytes(key, &snapshot, sizeof(snapshot));
+    checkpointBusy = false;
+  }
+}
+
+}  // namespace
+
+void energyBegin() {
+  // Newest valid entry of the ring wins; a torn write just fails its CRC.
+  Preferences prefs;
+  prefs.begin("energy", true);
+  for (uint8_t slot = 0; slot < ENERGY_RING_SLOTS; slot++) {
+    char key[4];
+    ringKey(slot, key);
+    EnergyCheckpoint entry;
+    if (prefs.getBytes(key, &entry, sizeof(entry)) != sizeof(entry)) { continue; }
+    if (entry.crc != checkpointCrc(entry) || entry.sequence < sequence) { continue; }
+    sequence = entry.sequence;
+    for (uint8_t step = 0; step <= NUM_OF_STEPS; step++) {
+      meters[step].milliwattMillis = entry.milliwattHours[step] * MS_PER_MWH;
+      meters[step].onMillis = entry.onSeconds[step] * 1000ULL;
+    }
+  }
+  prefs.end();
+
+  checkpointMillis = millis();
+  xTaskCreatePinnedToCore(checkpointLoop, "energy", 3072, nullptr, 1, &checkpointTask, 0);
+  statsRegisterTask(checkpointTask);
+  if (DEBUG) {Serial.print("Energy checkpoint: "); Serial.println(sequence);}
+}
+
+void energyCharge(uint16_t channel, uint8_t oldValue, uint8_t newValue) {
+  StepMeter &m = meters[channelStep[channel]];
+  chargeStep(m, millis());
+  m.loadMilliwatts += channelLoad(channel, newValue) - channelLoad(channel, oldValue);
+  if (oldValue == 0) { m.litChannels++; }
+  if (newValue == 0) { m.litChannels--; }
+}
+
+void energyCheckpoint(bool idle) {
+  uint32_t now = millis();
+  if (!idle || now - checkpointMillis < ENERGY_CHECKPOINT_INTERVAL || checkpointBusy || !checkpointTask) { return; }
+  checkpointMillis = now;
+
+  snapshot.sequence = ++sequence;
+  for (uint8_t step = 0; step <= NUM_OF_STEPS; step++) {
+    chargeStep(meters[step], now);
+    snapshot.milliwattHours[step] = meters[step].milliwattMillis / MS_PER_MWH;
+    snapshot.onSeconds[step] = meters[step].onMillis / 1000;
+  }
+  snapshot.crc = checkpointCrc(snapshot);
+  checkpointBusy = true;
+  xTaskNotifyGive(checkpointTask);
+}
+
+void reportEnergy() {
+  uint32_t now = millis();
+  for (uint8_t step = 0; step <= NUM_OF_STEPS; step++) {
+    StepMeter &m = meters[step];
+    chargeStep(m, now);
+    if (step == 0 && m.milliwattMillis == 0) { continue; }
+    Serial.printf("%s %2u: %8.2f h %10.2f Wh\n", step ? "Step" : "Other", step,
+                  m.onMillis / 3600000.0, m.milliwattMillis / (MS_PER_MWH * 1000.0));
+  }
+  Serial.print("Checkpoint: "); Serial.println(sequence);
+}
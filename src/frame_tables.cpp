@@ -0,0 +1,193 @@
+#include <Arduino.h>
+#include <array>
+
+#include "config.h"
+#include "frame_tables.h"
+
+namespace {
+
+// ---- Compile-time table generation ----
+
+constexpr WaveTrigger segmentTrigger(uint8_t segment) {
+  return WaveTrigger{(uint8_t)(segment < SEGMENT_DOWN_FILL ? WAVE_UP : WAVE_DOWN), 0, 0};
+}
+
+constexpr bool segmentClears(uint8_t segment) {
+  return segment == SEGMENT_UP_CLEAR || segment == SEGMENT_DOWN_CLEAR;
+}
+
+// Elapsed time of a segment's first frame, measured from the trigger.
+constexpr uint32_t segmentStart(uint8_t segment) {
+  return segmentClears(segment) ? waveClearStart(showConfig, segmentTrigger(segment)) : 0;
+}
+
+constexpr uint16_t segmentFrames(uint8_t segment) {
+  return (segmentClears(segment)
+          ? waveEndTime(showConfig, segmentTrigger(segment)) - waveClearStart(showConfig, segmentTrigger(segment))
+          : waveLitTime(showConfig)) / FRAME_UPDATE_DELAY + 1;
+}
+
+constexpr uint8_t segmentBase(uint8_t segment) {
+  return segmentClears(segment) ? STEP_ON_LEVEL : 0;
+}
+
+struct CountSink {
+  size_t size = 0;
+  constexpr void put(uint8_t) { size++; }
+};
+
+template <size_t N>
+struct ArraySink {
+  std::array<uint8_t, N> data{};
+  size_t size = 0;
+  constexpr void put(uint8_t value) { data[size++] = value; }
+};
+
+template <typename Sink>
+constexpr void encodeSegment(uint8_t segment, Sink &sink) {
+  const WaveTrigger t = segmentTrigger(segment);
+  uint8_t levels[NUM_OF_STEPS + 1] = {};
+  for (uint8_t step = 1; step <= NUM_OF_STEPS; step++) { levels[step] = segmentBase(segment); }
+
+  uint16_t lastFrame = 0;
+  for (uint16_t frame = 0; frame < segmentFrames(segment); frame++) {
+    uint32_t elapsed = segmentStart(segment) + (uint32_t)frame * FRAME_UPDATE_DELAY;
+    uint8_t changes = 0;
+    for (uint8_t step = 1; step <= NUM_OF_STEPS; step++) {
+      if (waveLevel(showConfig, t, step, elapsed) != levels[step]) { changes++; }
+    }
+    if (changes == 0) { continue; }
+
+    uint16_t gap = frame - lastFrame;
+    while (gap > 255) { sink.put(255); sink.put(0); gap -= 255; }
+    sink.put(gap);
+    sink.put(changes);
+    for (uint8_t step = 1; step <= NUM_OF_STEPS; step++) {
+      uint8_t level = waveLevel(showConfig, t, step, elapsed);
+      if (level == levels[step]) { continue; }
+      sink.put(step);
+      sink.put(level);
+      levels[step] = level;
+    }
+    lastFrame = frame;
+  }
+}
+
+constexpr size_t encodedSize(uint8_t segment) {
+  CountSink sink;
+  encodeSegment(segment, sink);
+  return sink.size;
+}
+
+template <uint8_t Segment>
+constexpr std::array<uint8_t, encodedSize(Segment)> buildTable() {
+  ArraySink<encodedSize(Segment)> sink;
+  encodeSegment(Segment, sink);
+  return sink.data;
+}
+
+constexpr auto upFill    = buildTable<SEGMENT_UP_FILL>();
+constexpr auto upClear   = buildTable<SEGMENT_UP_CLEAR>();
+constexpr auto downFill  = buildTable<SEGMENT_DOWN_FILL>();
+constexpr auto downClear = buildTable<SEGMENT_DOWN_CLEAR>();
+
+// ---- Playback ----
+
+struct TablePlayer {
+  uint8_t  segment = NUM_SEGMENTS;
+  uint16_t frame = 0;
+  uint16_t cursor = 0;
+  uint16_t recordFrame = 0;   // frame of the last applied record
+  uint8_t  levels[NUM_OF_STEPS + 1] = {};
+};
+
+TablePlayer player;
+
+// Moves the player to a frame of a segment, restarting only when seeking backwards.
+void seekTable(uint8_t segment, uint16_t frame) {
+  const FrameTable &table = frameTables[segment];
+  if (segment != player.segment || frame < player.frame) {
+    player.segment = segment;
+    player.cursor = 0;
+    player.recordFrame = 0;
+    memset(player.levels, table.baseLevel, sizeof(player.levels));
+  }
+  while (player.cursor < table.size) {
+    uint16_t at = player.recordFrame + table.data[player.cursor];
+    if (at > frame) { break; }
+    uint8_t changes = table.data[player.cursor + 1];
+    const uint8_t *change = &table.data[player.cursor + 2];
+    for (uint8_t i = 0; i < changes; i++, change += 2) {
+      player.levels[change[0]] = change[1];
+    }
+    player.cursor += 2 + 2 * changes;
+    player.recordFrame = at;
+  }
+  player.frame = frame;
+}
+
+}  // namespace
+
+const FrameTable frameTables[NUM_SEGMENTS] = {
+  {upFill.data(),    upFill.size(),    segmentFrames(SEGMENT_UP_FILL),    segmentBase(SEGMENT_UP_FILL)},
+  {upClear.data(),   upClear.size(),   segmentFrames(SEGMENT_UP_CLEAR),   segmentBase(SEGMENT_UP_CLEAR)},
+  {downFill.data(),  downFill.size(),  segmentFrames(SEGMENT_DOWN_FILL),  segmentBase(SEGMENT_DOWN_FILL)},
+  {downClear.data(), downClear.size(), segmentFrames(SEGMENT_DOWN_CLEAR), segmentBase(SEGMENT_DOWN_CLEAR)},
+};
+
+bool frameTablesMatch(const RuntimeConfig &c) {
+  // The hold is not in the tables; clear segments are timed from the clear start, which is
+  // only right if every step is fully lit by then.
+  return c.numSteps == showConfig.numSteps && c.stepDelay == showConfig.stepDelay &&
+         c.clearStepDelay == showConfig.clearStepDelay && c.holdDelay >= waveRampTime(c);
+}
+
+void tableWaveLevels(const RuntimeConfig &c, const WaveTrigger &t, uint32_t elapsed, uint8_t *levels) {
+  uint8_t fill = t.direction == WAVE_DOWN ? SEGMENT_DOWN_FILL : SEGMENT_UP_FILL;
+  uint8_t level = 0;
+  switch (wavePhase(c, t, elapsed)) {
+    case PHASE_FILLING:
+      seekTable(fill, elapsed / FRAME_UPDATE_DELAY);
+      memcpy(levels, player.levels, sizeof(player.levels));
+      return;
+    case PHASE_CLEARING:
+      seekTable(fill + 1, (elapsed - waveClearStart(c, t)) / FRAME_UPDATE_DELAY);
+      memcpy(levels, player.levels, sizeof(player.levels));
+      return;
+    case PHASE_HOLDING:
+      level = STEP_ON_LEVEL;
+      break;
+    default:
+      break;
+  }
+  memset(levels + 1, level, NUM_OF_STEPS);
+}
+
+size_t frameTablesFlashBytes() {
+  return sizeof(upFill) + sizeof(upClear) + sizeof(downFill) + sizeof(downClear) + sizeof(frameTables);
+}
+
+void reportFrameTables() {
+  uint8_t levels[NUM_OF_STEPS + 1];
+  uint32_t frames = 0;
+  uint32_t computedMicros = 0;
+  uint32_t tableMicros = 0;
+
+  for (uint8_t direction = WAVE_UP; direction <= WAVE_DOWN; direction++) {
+    const WaveTrigger t = {direction, 0, 0};
+    for (uint32_t elapsed = 0; elapsed <= waveEndTime(showConfig, t); elapsed += FRAME_UPDATE_DELAY) {
+      uint32_t start = micros();
+      waveLevels(showConfig, t, elapsed, levels);
+      computedMicros += micros() - start;
+      start = micros();
+      tableWaveLevels(showConfig, t, elapsed, levels);
+      tableMicros += micros() - start;
+      frames++;
+    }
+  }
+
+  Serial.print("Frame tables: "); Serial.print((unsigned long)frameTablesFlashBytes());
+  Serial.print(" bytes flash, computed "); Serial.print(computedMicros * 1000UL / frames);
+  Serial.print(" ns/frame, table "); Serial.print(tableMicros * 1000UL / frames);
+  Serial.println(" ns/frame");
+}
@@ -17,161 +17,352 @@
  */
 
 
-#define DEBUG             1
+#include <Arduino.h>
 
-#define SENSOR1           25
-#define SENSOR2           26
+#include "config.h"
+#include "effects.h"
+#include "frame_tables.h"
+#include "effect_vm.h"
+#include "output.h"
+#include "scenes.h"
+#include "attract.h"
+#include "wave_tail.h"
+#include "trail.h"
+#include "energy.h"
+#include "boot.h"
+#include "warm_start.h"
+#include "runtime_config.h"
+#include "sensors.h"
+#include "ambient.h"
+#include "crowd.h"
+#include "stats.h"
+#include "recorder.h"
 
+uint32_t frameUpdateMillis = 0;
+WaveTrigger wave = {WAVE_NONE, 0, 0};
+uint8_t wave_phase = PHASE_IDLE;
+uint8_t stair_mode = STAIR_MODE;
+bool trail_active = false;
+uint8_t stepLevels[NUM_OF_STEPS + 1] = {};   // last level sent, indexed by step
+uint8_t idleScene = NO_SCENE;
+uint8_t walkScene = NO_SCENE;
 
-#define DEBOUNCE_DELAY    500
-#define STRIP_CLEAR_DELAY 10000
-#define STEP_UPDATE_DELAY 500
-#define STEP_CLEAR_DELAY  150
+char serialLine[COMMAND_MAX_LINE + 1];
+uint8_t serialLength = 0;
 
-#define NUM_OF_STEPS      16
+void io_Setup() {
+  Serial.println("Setting up IO");
+  sensorsBegin();
+}
 
-#include <Arduino.h>
-#include <SparkFunDMX.h>
+void printPhase(uint8_t phase){
+  if (phase == PHASE_HOLDING){
+    Serial.println(wave.direction == WAVE_UP ? "UP Sequence Completed" : "DOWN Sequence Completed");
+  } else if (phase == PHASE_DONE){
+    Serial.println("Steps Cleared!!!");
+  }
+}
 
-SparkFunDMX dmx;
+void triggerWave(uint8_t direction){
+  const RuntimeConfig &cfg = configActive();
+  uint32_t elapsed = millis() - wave.startMillis;
+  switch (wavePhase(cfg, wave, elapsed)){
+    case PHASE_IDLE:
+    case PHASE_DONE:
+      wave = {direction, millis(), 0};
+      sceneGo(walkScene);
+      break;
+    case PHASE_CLEARING:
+      wave = waveResume(cfg, wave, elapsed);
+      break;
+    default:
+      wave.holdElapsed = elapsed;   // keep the strip lit for another hold time
+      break;
+  }
+}
 
-uint32_t sensorUpdateMillis = 0;
-uint32_t stepUpdateMillis = 0;
-uint32_t stripClearMillis = 0;
-uint32_t stepClearUpdateMillis = 0;
-uint8_t step_count = 1;
-uint8_t step_down_count = NUM_OF_STEPS;
-uint8_t sequence_active = 0;
+// The trail needs both ends to pair arrivals, so a single working sensor drives the wave.
+bool trailMode(){
+  return stair_mode == MODE_TRAIL && !sensorsSingleMode();
+}
 
-void io_Setup() {
-  Serial.println("Setting up IO");
-  pinMode(SENSOR1, INPUT_PULLUP);
-  pinMode(SENSOR2, INPUT_PULLUP);
+// Someone seen mid-stair keeps a running wave lit, or starts one from the
+// nearer end. The trail only tracks walkers between the ends.
+void onPresence(uint8_t step){
+  if (trailMode()){ return; }
+  if (wave.direction != WAVE_NONE){ triggerWave(wave.direction); return; }
+  triggerWave(step <= configActive().numSteps / 2 ? WAVE_UP : WAVE_DOWN);
+}
 
-  dmx.initWrite(20);
-  
+// Routes a sensor trigger to the wave or to the follow-me trail.
+void onSensor(uint8_t role, uint8_t index){
+  if (role != SENSOR_END){
+    if (!crowdActive()){ onPresence(index); }
+    return;
+  }
+  crowdTrigger(millis());                  // end sensors only, in and out of crowd mode
+  if (crowdActive()){ return; }            // already lit: just count it
+  uint8_t direction = index;
+  if (sensorsSingleMode()){
+    // One end flagged: the live end sees arrivals and departures alike, so each trigger
+    // starts a wave from its end or renews the running one, in either mode.
+    triggerWave(direction);
+  } else if (trailMode()){
+    if (!trailActive()){ sceneGo(walkScene); }
+    trailTrigger(direction, millis());
+  } else {
+    triggerWave(direction);
+  }
 }
 
-void showStep(int step){
-  dmx.write(step, 255);
-  dmx.update(); dmx.update();
-  if (DEBUG) {Serial.print("Showing Step: "); Serial.println(step);}
+bool stairsIdle(){
+  return wave.direction == WAVE_NONE && !trailActive();
 }
 
-void clearStep(int step){
-  dmx.write(step, 0);
-  dmx.update(); dmx.update();
-  if (DEBUG) {Serial.print("Clearing Step: "); Serial.println(step);}
+// Crowd mode keeps a wave lit: started or resumed if needed, its hold renewed
+// well before it runs out so the snapshot isn't rewritten every frame.
+void holdCrowd(){
+  const RuntimeConfig &cfg = configActive();
+  uint32_t elapsed = millis() - wave.startMillis;
+  if (wave.direction == WAVE_NONE || wavePhase(cfg, wave, elapsed) >= PHASE_CLEARING){ triggerWave(WAVE_UP); return; }
+  if (elapsed - wave.holdElapsed > cfg.holdDelay / 2){ wave.holdElapsed = elapsed; }
 }
 
-void stepUpSequence(){
-  if (step_count <= NUM_OF_STEPS  && sequence_active == 1){
-    if (millis() - stepUpdateMillis < STEP_UPDATE_DELAY){ return; }
-    // if (DEBUG) {Serial.print("Step Count: "); Serial.println(step_count);}
-    showStep(step_count);
-    stepUpdateMillis = millis();
-    step_count++;
-    if (step_count > NUM_OF_STEPS){
-      if (DEBUG) {Serial.println("UP Sequence Completed");}
-      stripClearMillis = millis();
-    }
-  }
+// Full frame rate while something moves, ATTRACT_FRAME_DELAY while the stairs are idle or held lit.
+uint16_t frameDelay(){
+  bool settled = stairsIdle() || (crowdActive() && wave_phase == PHASE_HOLDING);
+  bool idle = settled && !vmActive() && sceneActiveFades() == 0;
+  return idle ? ATTRACT_FRAME_DELAY : FRAME_UPDATE_DELAY;
 }
 
-void stepDownSequence(){
-  if (step_down_count > 0 && sequence_active == 2){
-    if (millis() - stepUpdateMillis < STEP_UPDATE_DELAY){ return; }
-    // if (DEBUG) {Serial.print("Step Count: "); Serial.println(step_down_count);}
-    showStep(step_down_count);
-    stepUpdateMillis = millis();
-    step_down_count--;
-    if (step_down_count == 0){
-      stripClearMillis = millis();
-      if (DEBUG) {Serial.println("DOWN Sequence Completed");}
-    }
+// Evaluates the wave for the current time and sends only the steps that changed.
+void renderFrame(){
+  if (millis() - frameUpdateMillis < frameDelay()){ return; }
+  uint32_t frameStart = micros();
+  frameUpdateMillis = millis();
+  if (crowdUpdate(frameUpdateMillis)){ holdCrowd(); }
+  uint32_t elapsed = frameUpdateMillis - wave.startMillis;
+  const RuntimeConfig &cfg = configActive();
+
+  uint8_t levels[NUM_OF_STEPS + 1];
+  if (trailMode() && wave.direction == WAVE_NONE){   // in trail mode only crowd mode runs a wave
+    trailLevels(frameUpdateMillis, levels);
+    if (trail_active && !trailActive()){ sceneGo(idleScene); }
+    trail_active = trailActive();
+  } else {
+#if USE_FRAME_TABLES
+    if (frameTablesMatch(cfg)){ tableWaveLevels(cfg, wave, elapsed, levels); }
+    else { waveLevels(cfg, wave, elapsed, levels); }
+#else
+    waveLevels(cfg, wave, elapsed, levels);
+#endif
+    tailApply(cfg, wave, elapsed, levels);
   }
-}
+  if (vmActive()){ vmRun(levels); }
+  attractSetIdle(stairsIdle(), frameUpdateMillis);
+  if (attractActive(frameUpdateMillis)){ attractLevels(frameUpdateMillis, levels); }
+  memset(levels + cfg.numSteps + 1, 0, NUM_OF_STEPS - cfg.numSteps);   // patched steps not in use stay dark
 
-void clearStepsSequence(){
-  if (sequence_active == 3){
-    if (millis() - stepUpdateMillis < STEP_CLEAR_DELAY){ return; }
-    clearStep(step_count);
-    step_count--;
-    stepUpdateMillis = millis();
-    if (step_count == 0){
-      if (DEBUG) {Serial.println("Steps Cleared!!!");}
-      sequence_active = 0; step_count = 1; 
-    }
+  for (uint8_t step = 1; step <= NUM_OF_STEPS; step++){
+    uint8_t level = levels[step];
+    if (level == stepLevels[step]){ continue; }
+    if (DEBUG && (level == 0 || stepLevels[step] == 0)) {Serial.print(level ? "Showing Step: " : "Clearing Step: "); Serial.println(step);}
+    stepLevels[step] = level;
+    outputStep(step, level);
   }
-  if (sequence_active == 4){
-    if (millis() - stepUpdateMillis < STEP_CLEAR_DELAY){ return; }
-    clearStep(step_down_count);
-    step_down_count++;
-    stepUpdateMillis = millis();
-    if (step_down_count > NUM_OF_STEPS){
-      if (DEBUG) {Serial.println("Steps Cleared!!!");}
-      sequence_active = 0; step_down_count = NUM_OF_STEPS;
-    }
+  sceneRender(frameUpdateMillis);
+  outputCommit();
+  warmUpdate(frameUpdateMillis, wave, stair_mode, sceneCurrent, stepLevels);
+
+  uint8_t phase = wavePhase(cfg, wave, elapsed);
+  if (phase != wave_phase){
+    if (DEBUG) {printPhase(phase);}
+    wave_phase = phase;
   }
-}
-void clearSequenceCheck(){
-  if (sequence_active == 1 && step_count > NUM_OF_STEPS){
-    if (millis() - stripClearMillis < STRIP_CLEAR_DELAY){ return; }
-    sequence_active = 3;
-    // if (DEBUG) {Serial.println("Steps Cleared!!!");}
-  } else if (sequence_active == 2 && step_down_count == 0){
-    if (millis() - stripClearMillis < STRIP_CLEAR_DELAY){ return; }
-    sequence_active = 4;
-    // if (DEBUG) {Serial.println("Steps Cleared!!!");}
+  if (phase == PHASE_DONE){
+    wave.direction = WAVE_NONE;
+    sceneGo(idleScene);
   }
+  if (attractActive(frameUpdateMillis)){ attractFrameDone(frameStart); }
 }
 
 void readSensors(){
-  if (digitalRead(SENSOR1) == HIGH){
-    if (millis() - sensorUpdateMillis < DEBOUNCE_DELAY){ return; }
-      sensorUpdateMillis = millis();
-      stripClearMillis = millis();
-      if (DEBUG) {Serial.println("Sensor 1 Triggered");}
-      if (sequence_active != 2){ sequence_active = 1; }
+  sensorsPoll(millis(), onSensor);
+}
+
+void cmdStopWave(char *){
+  wave.direction = WAVE_NONE;
+  sceneGo(idleScene);
+}
+
+void cmdEffect(char *args){
+  if (strcmp(args, "off") == 0){ vmUnload(); Serial.println("Effect off"); return; }
+  if (strcmp(args, "bench") == 0){ vmBenchmark(); return; }
+  Serial.println(vmLoadText(args) ? "Effect loaded" : "Invalid effect program");
+}
+
+void cmdMode(char *args){
+  if (strcmp(args, "trail") == 0){ stair_mode = MODE_TRAIL; wave.direction = WAVE_NONE; }
+  else if (strcmp(args, "wave") == 0){ stair_mode = MODE_WAVE; }
+  Serial.print(stair_mode == MODE_TRAIL ? "Mode: trail, traversal ms: " : "Mode: wave, traversal ms: ");
+  Serial.println(trailTraversalMillis());
+}
+
+void cmdEnergy(char *){
+  reportEnergy();
+}
+
+void cmdSensors(char *){
+  reportSensors();
+}
+
+void cmdStats(char *){
+  reportStats();
+}
+
+void cmdCrowd(char *){
+  reportCrowd();
+}
+
+void cmdAmbient(char *){
+  reportAmbient();
+}
+
+void cmdPower(char *){
+  reportPower();
+}
+
+void cmdDmx(char *args){
+  if (!strcmp(args, "check")){ reportDmxCheck(); }
+  else if (!strcmp(args, "in")){ reportDmxInput(); }
+  else if (!strcmp(args, "in reset")){ resetDmxInputStats(); }
+  else { reportDmxBench(); }
+}
+
+void cmdRecord(char *args){
+  if (!strcmp(args, "flush")){ recordFlush(); }
+  else if (!strncmp(args, "dump", 4)){ recordDump(args[4] ? atoi(args + 5) : 4); }
+  else { reportRecord(); }
+}
+
+void cmdAttract(char *){
+  reportAttract();
+}
+
+void cmdScene(char *args){
+  uint8_t scene = sceneFind(args);
+  if (scene == NO_SCENE){ Serial.println("Unknown scene"); return; }
+  sceneGo(scene);
+}
+
+void cmdConfig(char *args){
+  char *value = strchr(args, ' ');
+  if (value){ *value++ = '\0'; }
+  if (strcmp(args, "save") == 0){ configSave(); Serial.println("Config saved"); return; }
+  if (strcmp(args, "reset") == 0){ configReset(); }
+  else if (*args && (!value || !configSet(args, strtoul(value, nullptr, 10)))){ Serial.println("Invalid config"); return; }
+  reportConfig();
+}
+
+void cmdBoot(char *args){
+  if (strcmp(args, "blackout") == 0){ bootSetScene(NO_SCENE); }
+  else if (*args){
+    uint8_t scene = sceneFind(args);
+    if (scene == NO_SCENE){ Serial.println("Unknown scene"); return; }
+    bootSetScene(scene);
   }
-  if (digitalRead(SENSOR2) == HIGH){
-    if (millis() - sensorUpdateMillis < DEBOUNCE_DELAY){ return; }
-      sensorUpdateMillis = millis();
-      stripClearMillis = millis();
-      if (DEBUG) {Serial.println("Sensor 2 Triggered");}
-      if (sequence_active != 1) {sequence_active = 2;}
+  reportBoot();
+}
+
+struct SerialCommand {
+  const char *name;
+  void (*run)(char *args);
+};
+
+const SerialCommand serialCommands[] = {
+  {"A",      cmdStopWave},
+  {"B",      cmdStopWave},
+  {"effect", cmdEffect},     // effect <builtin name | hex program | off | bench>
+  {"scene",  cmdScene},      // scene <name>
+  {"attract", cmdAttract},   // cost of frames rendered with the glow, and CPU share
+  {"mode",   cmdMode},       // mode <wave | trail>
+  {"sensors", cmdSensors},   // sensor levels and health
+  {"stats",  cmdStats},      // heap, allocations after setup and task stacks
+  {"crowd",  cmdCrowd},      // trigger rate estimate and crowd mode state
+  {"ambient", cmdAmbient},   // ambient reading and brightness scale
+  {"power",  cmdPower},      // estimated load and limiter scale
+  {"dmx",    cmdDmx},        // dmx [check | in [reset]]: engine CPU time per frame, encoding check or console input
+  {"record", cmdRecord},     // record [flush | dump [<blocks>]]: frame recorder state, or its newest blocks as hex
+  {"energy", cmdEnergy},     // lamp hours and Wh per step
+  {"config", cmdConfig},     // config [<steps|debounce|hold|step|clear> <value> | save | reset]
+  {"boot",   cmdBoot},       // boot [<scene> | blackout]: boot look and time to first frame
+};
+
+void runCommand(char *line){
+  char *args = strchr(line, ' ');
+  if (args){ *args++ = '\0'; } else { args = line + strlen(line); }
+  for (const SerialCommand &command : serialCommands){
+    if (strcmp(line, command.name) != 0){ continue; }
+    statsPause(true);
+    command.run(args);
+    statsPause(false);
+    return;
   }
+  if (DEBUG) {Serial.print("Unknown command: "); Serial.println(line);}
 }
 
+// Collects a line from the serial port and runs it as a command.
 void readSerial(){
-  if (Serial.available() > 0) {
+  while (Serial.available() > 0) {
     char incoming = Serial.read();
-    if (incoming == 'A'){
-      sequence_active = 0; step_count = 1; step_down_count = NUM_OF_STEPS;
-      // TODO: Call Function to start the sequence.
-    }
-    if (incoming == 'B'){
-      sequence_active = 0;
-      // TODO: Call Function to Clear the sequence.
+    if (incoming == '\n' || incoming == '\r'){
+      if (serialLength == 0){ continue; }
+      serialLine[serialLength] = '\0';
+      serialLength = 0;
+      runCommand(serialLine);
+    } else if (serialLength < COMMAND_MAX_LINE){
+      serialLine[serialLength++] = incoming;
     }
   }
 }
 
 void debugPins(){
-  Serial.println("S1: " + String(digitalRead(SENSOR1)) + " \t S2: " + String(digitalRead(SENSOR2)));
+  Serial.print("S1: "); Serial.print(digitalRead(SENSOR1));
+  Serial.print(" \t S2: "); Serial.println(digitalRead(SENSOR2));
 }
 
 void setup() {
-  Serial.begin(9600);
+  WarmState warm;
+  bool warmStart = warmRestore(warm);
+  bootBegin(warmStart ? &warm : nullptr);   // DMX first, so the fixtures get a known frame before anything slower starts
+  if (warmStart) {
+    configLoad();   // the snapshot's wave ran on the stored config, not the show defaults
+    wave = warm.wave;
+    stair_mode = warm.mode;
+    memcpy(stepLevels, warm.levels, sizeof(stepLevels));
+    wave_phase = wavePhase(configActive(), wave, millis() - wave.startMillis);
+  }
+  Serial.setTxBufferSize(SERIAL_TX_BUFFER);
+  Serial.begin(SERIAL_BAUD);
   io_Setup();
+  dmxInputBegin();
+  ambientBegin();
+  energyBegin();
+  recordBegin();
+  if (!warmStart) {configBegin();}
+  idleScene = sceneFind("idle");
+  walkScene = sceneFind("walk");
+  if (!warmStart) {sceneGo(idleScene);}
+  if (DEBUG) {reportBoot(); reportFrameTables();}
+  statsArm();   // nothing below setup() may allocate
 }
 
 void loop() {
-  // readSerial();
+  configSwap();   // between frames, so a frame never mixes two configs
+  readSerial();
   readSensors();
-  stepUpSequence();
-  stepDownSequence();
-  clearSequenceCheck();
-  clearStepsSequence();
+  renderFrame();
+  energyCheckpoint(stairsIdle());
+  recordUpdate(millis(), stairsIdle());
   // debugPins();
 }
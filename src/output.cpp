@@ -0,0 +1,203 @@
+#include <Arduino.h>
+
+#include "config.h"
+#include "output.h"
+#include "energy.h"
+#include "ambient.h"
+#include "recorder.h"
+#include <DmxRx.h>
+
+OutputUniverse dmx;
+
+namespace {
+
+uint8_t waveLayer[show::dmxSlots + 1] = {};
+uint8_t sceneLayer[show::dmxSlots + 1] = {};
+uint8_t frame[show::dmxSlots + 1] = {};     // merged levels
+uint8_t limited[show::dmxSlots + 1] = {};   // after the power limiter, as sent
+bool frameChanged = false;
+
+// ---- Output scale: ambient brightness and power limiter ----
+
+uint32_t loadMilliwatts = 0;        // estimated draw of the merged frame at full brightness
+uint16_t ambientScale = 256;        // 256 = unity
+uint16_t powerScale = 256;
+uint16_t outputScale = 256;         // ambient * power, applied to every channel
+uint32_t scaleHigh = show::powerBudget ? show::powerBudget : UINT32_MAX;
+uint32_t scaleLow = 0;
+
+inline uint32_t channelLoad(uint16_t channel, uint8_t value) {
+  return (uint32_t)value * show::channelMilliwatts[channel] / 255;
+}
+
+void limitChannel(uint16_t channel) {
+  uint8_t value = frame[channel] * outputScale >> 8;
+  if (value == limited[channel]) { return; }
+  energyCharge(channel, limited[channel], value);
+  limited[channel] = value;
+  frameChanged = true;
+}
+
+/**
+ * The power scale is cached and only recomputed when the load leaves the
+ * band it was computed for: above it the output would exceed the budget,
+ * below it by more than the hysteresis the output is needlessly dimmed.
+ */
+void updatePowerScale(uint32_t load) {
+  if (load <= scaleHigh && load >= scaleLow) { return; }
+  powerScale = load <= show::powerBudget ? 256 : (uint64_t)show::powerBudget * 256 / load;
+  scaleHigh = powerScale == 256 ? show::powerBudget : (uint64_t)show::powerBudget * 256 / powerScale;
+  scaleLow = powerScale == 256 ? 0 : (uint64_t)scaleHigh * (100 - show::powerHysteresis) / 100;
+}
+
+// While the combined scale holds, a frame costs one multiply per changed
+// channel; when it moves, one multiply per channel.
+void updateOutputScale() {
+  ambientScale = ambientBrightness();
+  if (show::powerBudget) { updatePowerScale((uint64_t)loadMilliwatts * ambientScale >> 8); }
+  uint16_t scale = (uint32_t)ambientScale * powerScale >> 8;
+  if (scale == outputScale) { return; }
+  outputScale = scale;
+  for (uint16_t channel = 1; channel <= show::dmxSlots; channel++) { limitChannel(channel); }
+}
+
+void mergeChannel(uint16_t channel) {
+  uint8_t value = waveLayer[channel] > sceneLayer[channel] ? waveLayer[channel] : sceneLayer[channel];
+  if (value == frame[channel]) { return; }
+  loadMilliwatts += channelLoad(channel, value) - channelLoad(channel, frame[channel]);
+  frame[channel] = value;
+  limitChannel(channel);
+}
+
+}  // namespace
+
+void outputBegin() {
+#if DMX_ENGINE == DMX_ENGINE_I2S
+  dmx.begin(dmxParallelPins);
+#else
+  dmx.begin();
+#endif
+  frameChanged = true;   // the first commit always goes out, even if it is blackout
+}
+
+void outputStep(uint8_t step, uint8_t level) {
+  const uint8_t *colour = show::colour[step - 1];
+  uint16_t channel = show::patch[step - 1];
+  for (uint16_t c = 0; c < show::footprint; c++, channel++) {
+    waveLayer[channel] = colour[c] * level / 255;
+    mergeChannel(channel);
+  }
+}
+
+void outputScene(uint16_t channel, uint8_t value) {
+  sceneLayer[channel] = value;
+  mergeChannel(channel);
+}
+
+bool outputCommit() {
+  updateOutputScale();
+  if (!frameChanged) { return false; }
+#if DMX_ENGINE == DMX_ENGINE_I2S
+  dmx.write(0, 1, &limited[1], show::dmxSlots);
+#else
+  dmx.write(1, &limited[1], show::dmxSlots);
+#endif
+  dmx.update(); dmx.update();
+  recordFrame(millis(), &limited[1]);
+  frameChanged = false;
+  return true;
+}
+
+void reportPower() {
+  Serial.print("Power: load "); Serial.print((uint32_t)((uint64_t)loadMilliwatts * ambientScale >> 8) / 1000);
+  Serial.print(" W, budget "); Serial.print(show::powerBudget / 1000);
+  Serial.print(" W, scale "); Serial.print(powerScale * 100 / 256);
+  Serial.println(" %");
+}
+
+void reportDmxBench() {
+  const uint8_t frames = 20;
+  uint32_t cycles = 0;
+  for (uint8_t i = 0; i < frames; i++) {
+#if DMX_ENGINE == DMX_ENGINE_RMT
+    while (!dmxRmt.idle()) {}   // time the hand-off, not the previous frame's wire time
+#elif DMX_ENGINE == DMX_ENGINE_I2S
+    while (!dmxParallel.idle()) {}
+#endif
+    uint32_t start = ESP.getCycleCount();
+    dmx.update();
+    cycles += ESP.getCycleCount() - start;
+  }
+  cycles /= frames;
+  Serial.print(DMX_ENGINE == DMX_ENGINE_I2S ? "Engine: I2S" : DMX_ENGINE == DMX_ENGINE_RMT ? "Engine: RMT" : "Engine: UART");
+  Serial.print(", CPU us/frame "); Serial.print(cycles / ESP.getCpuFreqMHz());
+  Serial.print(", wire us/frame "); Serial.print(OutputUniverse::frameMicros);
+  Serial.print(", max Hz "); Serial.println(OutputUniverse::maxRefreshHz);
+#if DMX_ENGINE != DMX_ENGINE_I2S
+  // Side by side with the engine above: the RMT engine's CPU work per frame is
+  // this encode plus the DMA hand-off, whichever engine is built.
+  static uint32_t items[dmxRmtItems(OutputUniverse::packetSize)];   // static: too big for the loop stack
+  const DmxRmtTiming timing = {DMX_BREAK_MICROS, DMX_MAB_MICROS, 4};
+  uint32_t start = ESP.getCycleCount();
+  for (uint8_t i = 0; i < frames; i++) {
+    DmxRmtEncoder(items, dmxRmtItems(OutputUniverse::packetSize)).encode(dmx.packet(), OutputUniverse::packetSize, timing);
+  }
+  Serial.print("RMT encode of this frame, CPU us/frame ");
+  Serial.println((ESP.getCycleCount() - start) / frames / ESP.getCpuFreqMHz());
+#endif
+#if DMX_ENGINE == DMX_ENGINE_I2S
+  Serial.print("Measured wire us/frame "); Serial.println(dmxParallel.measure());
+#endif
+}
+
+void reportDmxCheck() {
+#if DMX_ENGINE == DMX_ENGINE_RMT
+  static uint32_t items[OutputUniverse::itemCount];   // static: too big for the loop stack
+  const DmxRmtTiming timing = {DMX_BREAK_MICROS, DMX_MAB_MICROS, 4};
+  DmxRmtEncoder encoder(items, OutputUniverse::itemCount);
+  size_t count = encoder.encode(dmx.packet(), OutputUniverse::packetSize, timing);
+  bool ok = count && dmxRmtVerify(items, count, dmx.packet(), OutputUniverse::packetSize, timing);
+  Serial.print("RMT items: "); Serial.print(count);
+  Serial.println(ok ? ", matches reference" : ", MISMATCH");
+#elif DMX_ENGINE == DMX_ENGINE_I2S
+  while (!dmxParallel.idle()) {}   // the samples are shared with the DMA
+  size_t count = dmx.encode();
+  Serial.print("I2S samples: "); Serial.print(count);
+  Serial.println(count && dmx.verify(count) ? ", all lines match reference" : ", MISMATCH");
+#else
+  Serial.println("UART engine: nothing to check");
+#endif
+}
+
+void dmxInputBegin() {
+  if (DMX_INPUT_ENABLE) { dmxRx.begin(DMX_INPUT_PIN); }
+}
+
+void reportDmxInput() {
+  if (!DMX_INPUT_ENABLE) { Serial.println("DMX input disabled"); return; }
+  dmxRx.receive();
+  Serial.print("Input frames: "); Serial.print(dmxRx.frames());
+  Serial.print(", size "); Serial.print(dmxRx.size());
+  Serial.print(", age ms "); Serial.println(millis() - dmxRx.lastFrameMillis());
+  for (uint16_t slot = 1; slot <= 8 && slot < dmxRx.size(); slot++) { Serial.printf("%u ", dmxRx.read(slot)); }
+  Serial.println();
+
+  DmxRxStats stats;
+  dmxRx.stats(stats);
+  Serial.printf("Other start codes %u, oversize %u, framing errors %u, overruns %u\n", stats.otherStartCodes,
+                stats.oversize, stats.framingErrors, stats.overruns);
+  Serial.printf("Breaks: short %u, long %u, last %u us; size changes %u\n", stats.shortBreaks, stats.longBreaks,
+                stats.lastBreak, stats.sizeChanges);
+  Serial.print("Intervals:");
+  for (uint8_t b = 0; b < DMX_RX_INTERVAL_BUCKETS; b++) {
+    if (!stats.intervals[b]) { continue; }
+    if (b == DMX_RX_INTERVAL_BUCKETS - 1) { Serial.print(" longer"); }
+    else { Serial.printf(" <%lu ms", (1UL << (DMX_RX_INTERVAL_MIN + b)) / 1000); }
+    Serial.printf(": %u", stats.intervals[b]);
+  }
+  Serial.println();
+}
+
+void resetDmxInputStats() {
+  if (DMX_INPUT_ENABLE) { dmxRx.resetStats(); }
+}
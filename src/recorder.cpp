@@ -0,0 +1,296 @@
+#include <Arduino.h>
+#include <esp_partition.h>
+
+#include "config.h"
+#include "recorder.h"
+#include "stats.h"
+
+namespace {
+
+struct BlockHeader {
+  uint32_t magic;
+  uint32_t sequence;
+  uint32_t session;
+  uint16_t slots;
+  uint16_t headerSize;
+};
+
+constexpr uint16_t slots = show::dmxSlots;
+constexpr size_t keyframeSize = 5 + slots;
+
+static_assert(sizeof(BlockHeader) == 16, "block header is part of the stream format");
+static_assert(sizeof(BlockHeader) + keyframeSize <= RECORD_BLOCK_SIZE, "a keyframe must fit a block");
+
+const esp_partition_t *ring = nullptr;
+uint32_t ringBlocks = 0;
+uint32_t session = 0;
+uint32_t sequence = 0;          // of the block being filled
+
+uint8_t blocks[2][RECORD_BLOCK_SIZE];
+uint8_t active = 0;             // block being filled; the other may be with the writer
+uint16_t used = 0;
+uint32_t blockMillis = 0;       // first record of the active block
+
+uint8_t previous[slots] = {};
+uint8_t delta[keyframeSize];    // a delta larger than a keyframe is sent as one
+uint32_t lastMillis = 0;
+uint32_t keyMillis = 0;
+bool needKeyframe = true;
+
+enum WriterJob : uint8_t { JOB_WRITE, JOB_ERASE };
+
+TaskHandle_t writerTask = nullptr;
+volatile bool writerBusy = false;
+uint8_t writerJob = JOB_WRITE;
+uint8_t writerBlock = 0;
+uint32_t writerSequence = 0;
+
+uint32_t erasedUntil = 0;       // sectors of sequences sequence..erasedUntil - 1 are erased
+uint32_t eraseAhead = 0;        // RECORD_ERASE_AHEAD, limited to the ring
+uint32_t eraseMillis = 0;
+
+// Time spent in flash calls: the cache is off on both cores meanwhile, so this is the loop's stall.
+struct FlashStall {
+  uint32_t count;
+  uint32_t maxMicros;
+  uint64_t totalMicros;
+};
+
+FlashStall eraseStall = {};
+FlashStall writeStall = {};
+
+// Dump in progress: blocks dumpSequence..dumpEnd - 1, the next line at dumpOffset.
+constexpr uint16_t dumpLineBytes = 64;
+constexpr int dumpLineMax = 26 + 2 * dumpLineBytes;   // "R <sequence> <offset> <hex>\r\n"
+uint32_t dumpSequence = 0;
+uint32_t dumpEnd = 0;
+uint16_t dumpOffset = 0;
+
+// Measured cost and volume.
+uint32_t frames = 0;
+uint32_t keyframes = 0;
+uint32_t dropped = 0;
+uint64_t bytes = 0;
+uint64_t totalCycles = 0;
+uint32_t maxCycles = 0;
+
+void measure(FlashStall &stall, uint32_t start) {
+  uint32_t elapsed = micros() - start;
+  stall.count++;
+  stall.totalMicros += elapsed;
+  if (elapsed > stall.maxMicros) { stall.maxMicros = elapsed; }
+}
+
+void writerLoop(void *) {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    uint32_t offset = writerSequence % ringBlocks * RECORD_BLOCK_SIZE;
+    uint32_t start = micros();
+    if (writerJob == JOB_ERASE) {
+      esp_partition_erase_range(ring, offset, RECORD_BLOCK_SIZE);
+      measure(eraseStall, start);
+    } else {
+      esp_partition_write(ring, offset, blocks[writerBlock], RECORD_BLOCK_SIZE);
+      measure(writeStall, start);
+    }
+    writerBusy = false;
+  }
+}
+
+// Hands the next sector ahead of the write position to the writer for erasing. False while it is busy.
+bool eraseNext() {
+  if (writerBusy) { return false; }
+  writerJob = JOB_ERASE;
+  writerSequence = erasedUntil++;
+  writerBusy = true;
+  xTaskNotifyGive(writerTask);
+  return true;
+}
+
+void openBlock() {
+  BlockHeader header = {RECORD_MAGIC, sequence, session, slots, sizeof(BlockHeader)};
+  memcpy(blocks[active], &header, sizeof(header));
+  used = sizeof(BlockHeader);
+  needKeyframe = true;
+}
+
+// Pads the active block with erased bytes and hands it to the writer. False while the writer
+// is busy or no erased sector is left for it.
+bool closeBlock() {
+  if (writerBusy || sequence >= erasedUntil) { return false; }
+  memset(blocks[active] + used, 0xFF, RECORD_BLOCK_SIZE - used);
+  writerJob = JOB_WRITE;
+  writerBlock = active;
+  writerSequence = sequence;
+  writerBusy = true;
+  xTaskNotifyGive(writerTask);
+  active ^= 1;
+  sequence++;
+  openBlock();
+  return true;
+}
+
+// XOR/RLE against the previous frame. Returns the token bytes, or 0 if they would not fit.
+size_t encodeDelta(const uint8_t *frame) {
+  size_t n = 0;
+  uint16_t c = 0;
+  while (c < slots) {
+    uint16_t start = c;
+    while (c < slots && frame[c] == previous[c] && c - start < 128) { c++; }
+    if (c > start) {
+      if (n >= sizeof(delta)) { return 0; }
+      delta[n++] = c - start - 1;
+      continue;
+    }
+    while (c < slots && frame[c] != previous[c] && c - start < 128) { c++; }
+    uint16_t length = c - start;
+    if (n + 1 + length > sizeof(delta)) { return 0; }
+    delta[n++] = 0x80 | (length - 1);
+    for (uint16_t i = start; i < c; i++) { delta[n++] = frame[i] ^ previous[i]; }
+  }
+  return n;
+}
+
+// Prints dump lines while the console's transmit buffer takes a whole line, so a dump never
+// blocks the loop; the rest follows on the next passes.
+void dumpLines() {
+  static const char hex[] = "0123456789abcdef";
+  while (dumpSequence < dumpEnd && Serial.availableForWrite() >= dumpLineMax) {
+    uint8_t bytes[dumpLineBytes];
+    esp_partition_read(ring, dumpSequence % ringBlocks * RECORD_BLOCK_SIZE + dumpOffset, bytes, sizeof(bytes));
+    char text[dumpLineMax + 1];
+    int n = snprintf(text, sizeof(text), "R %u %u ", dumpSequence, dumpOffset);
+    for (uint8_t b : bytes) {
+      text[n++] = hex[b >> 4];
+      text[n++] = hex[b & 0x0F];
+    }
+    text[n++] = '\r';
+    text[n++] = '\n';
+    Serial.write((const uint8_t *)text, n);
+    dumpOffset += dumpLineBytes;
+    if (dumpOffset == RECORD_BLOCK_SIZE) {
+      dumpOffset = 0;
+      dumpSequence++;
+    }
+  }
+}
+
+void put16(uint8_t *p, uint16_t v) { p[0] = v; p[1] = v >> 8; }
+void put32(uint8_t *p, uint32_t v) { put16(p, v); put16(p + 2, v >> 16); }
+
+}  // namespace
+
+void recordBegin() {
+  if (!RECORD_ENABLE) { return; }
+  ring = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS, nullptr);
+  if (!ring || ring->size < 2 * RECORD_BLOCK_SIZE) {
+    if (DEBUG) {Serial.println("Recorder: no data partition");}
+    ring = nullptr;
+    return;
+  }
+  ringBlocks = ring->size / RECORD_BLOCK_SIZE;
+
+  // Continue after the newest block of any earlier session.
+  for (uint32_t b = 0; b < ringBlocks; b++) {
+    BlockHeader header;
+    if (esp_partition_read(ring, b * RECORD_BLOCK_SIZE, &header, sizeof(header)) != ESP_OK) { continue; }
+    if (header.magic == RECORD_MAGIC && header.sequence + 1 > sequence) { sequence = header.sequence + 1; }
+  }
+  session = esp_random();
+  erasedUntil = sequence;
+  eraseAhead = RECORD_ERASE_AHEAD < ringBlocks - 2 ? RECORD_ERASE_AHEAD : ringBlocks - 2;
+  openBlock();
+
+  xTaskCreatePinnedToCore(writerLoop, "recorder", 2048, nullptr, 1, &writerTask, 0);
+  statsRegisterTask(writerTask);
+  if (DEBUG) {Serial.printf("Recorder: %u blocks, next %u\n", ringBlocks, sequence);}
+}
+
+void recordFrame(uint32_t now, const uint8_t *frame) {
+  if (!writerTask) { return; }
+  uint32_t start = ESP.getCycleCount();
+
+  bool key = needKeyframe || now - keyMillis >= RECORD_KEYFRAME_INTERVAL || now - lastMillis > UINT16_MAX;
+  size_t tokens = key ? 0 : encodeDelta(frame);
+  if (tokens == 0) { key = true; }
+  size_t size = key ? keyframeSize : 3 + tokens;
+  if (used + size > RECORD_BLOCK_SIZE) {
+    if (!closeBlock()) { dropped++; needKeyframe = true; return; }
+    key = true;
+    size = keyframeSize;
+  }
+
+  uint8_t *p = blocks[active] + used;
+  if (used == sizeof(BlockHeader)) { blockMillis = now; }
+  if (key) {
+    p[0] = 'K';
+    put32(p + 1, now);
+    memcpy(p + 5, frame, slots);
+    keyMillis = now;
+    needKeyframe = false;
+    keyframes++;
+  } else {
+    p[0] = 'D';
+    put16(p + 1, now - lastMillis);
+    memcpy(p + 3, delta, tokens);
+  }
+  used += size;
+  memcpy(previous, frame, slots);
+  lastMillis = now;
+
+  frames++;
+  bytes += size;
+  uint32_t cycles = ESP.getCycleCount() - start;
+  totalCycles += cycles;
+  if (cycles > maxCycles) { maxCycles = cycles; }
+}
+
+void recordUpdate(uint32_t now, bool idle) {
+  if (!writerTask) { return; }
+  dumpLines();
+  if (used > sizeof(BlockHeader) && now - blockMillis >= RECORD_FLUSH_INTERVAL) { closeBlock(); }
+  if (idle && erasedUntil - sequence < eraseAhead && now - eraseMillis >= RECORD_ERASE_INTERVAL && eraseNext()) {
+    eraseMillis = now;
+  }
+}
+
+void recordFlush() {
+  if (!writerTask) { return; }
+  while (writerBusy) { delay(1); }
+  if (used == sizeof(BlockHeader)) { return; }
+  if (sequence >= erasedUntil) {   // asked for over serial, so an erase now is acceptable
+    eraseNext();
+    while (writerBusy) { delay(1); }
+  }
+  closeBlock();
+  while (writerBusy) { delay(1); }
+}
+
+void recordDump(uint16_t count) {
+  if (!writerTask) { Serial.println("Recorder: no data partition"); return; }
+  recordFlush();
+  if (count > sequence) { count = sequence; }
+  if (count > ringBlocks) { count = ringBlocks; }
+  dumpSequence = sequence - count;
+  dumpEnd = sequence;
+  dumpOffset = 0;
+}
+
+void reportRecord() {
+  if (!writerTask) { Serial.println("Recorder off"); return; }
+  Serial.printf("Recorder: block %u of ring %u, session %08x, uptime %u ms\n", sequence, ringBlocks, session, millis());
+  Serial.printf("Frames %u, keyframes %u, dropped %u, %u bytes/frame\n", frames, keyframes, dropped,
+                frames ? (uint32_t)(bytes / frames) : 0);
+  uint32_t mhz = ESP.getCpuFreqMHz();
+  Serial.printf("Cost: avg %u us, max %u us per frame\n", frames ? (uint32_t)(totalCycles / frames / mhz) : 0,
+                maxCycles / mhz);
+  Serial.printf("Erased ahead: %u of %u blocks\n", erasedUntil - sequence, eraseAhead);
+  if (dumpSequence < dumpEnd) { Serial.printf("Dumping: %u blocks left\n", dumpEnd - dumpSequence); }
+  const FlashStall *stalls[] = {&eraseStall, &writeStall};
+  const char *names[] = {"erase", "write"};
+  for (uint8_t i = 0; i < 2; i++) {
+    const FlashStall &s = *stalls[i];
+    Serial.printf("Flash %s stall: %u x, avg %u us, max %u us\n", names[i], s.count,
+                  s.count ? (uint32_t)(s.totalMicros / s.count) : 0, s.maxMicros);
+  }
+}
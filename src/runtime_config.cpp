@@ -0,0 +1,129 @@
+#include <Arduino.h>
+#include <Preferences.h>
+#include <rom/crc.h>
+#include <atomic>
+
+#include "config.h"
+#include "effects.h"
+#include "runtime_config.h"
+#include "frame_tables.h"
+
+namespace {
+
+struct StoredConfig {
+  RuntimeConfig config;
+  uint32_t crc;
+};
+
+RuntimeConfig slots[2] = {};
+std::atomic<const RuntimeConfig *> active{&showConfig};
+std::atomic<RuntimeConfig *> pending{nullptr};   // staged block, published by configSwap()
+std::atomic<bool> loading{false};
+
+// The buffer not being read by the renderer.
+RuntimeConfig &spare() {
+  return active.load(std::memory_order_acquire) == &slots[0] ? slots[1] : slots[0];
+}
+
+uint32_t storedCrc(const StoredConfig &s) {
+  return crc32_le(0, (const uint8_t *)&s.config, sizeof(s.config));
+}
+
+// The same rules tools/showc.py applies to the show, plus the hold covering the edge: a
+// shorter hold would start clearing while the last step is still lighting.
+bool configValid(const RuntimeConfig &c) {
+  return c.numSteps >= 1 && c.numSteps <= NUM_OF_STEPS && c.stepDelay > 0 && c.clearStepDelay > 0 &&
+         c.holdDelay >= waveRampTime(c) && c.debounceDelay <= CONFIG_DEBOUNCE_MAX;
+}
+
+void stage(const RuntimeConfig &c) {
+  RuntimeConfig &next = spare();
+  next = c;
+  pending.store(&next, std::memory_order_release);
+}
+
+// The persisted block, if there is a valid one.
+bool loadStored(RuntimeConfig &out) {
+  StoredConfig stored;
+  Preferences prefs;
+  if (!prefs.begin("config", true)) { return false; }
+  bool ok = prefs.getBytes("timing", &stored, sizeof(stored)) == sizeof(stored) &&
+            stored.crc == storedCrc(stored) && configValid(stored.config);
+  prefs.end();
+  if (ok) { out = stored.config; }
+  return ok;
+}
+
+void loadTask(void *) {
+  RuntimeConfig c;
+  if (loadStored(c)) { stage(c); }
+  loading.store(false, std::memory_order_release);
+  vTaskDelete(nullptr);
+}
+
+}  // namespace
+
+const RuntimeConfig &configActive() {
+  return *active.load(std::memory_order_acquire);
+}
+
+void configBegin() {
+  loading.store(true);
+  if (xTaskCreate(loadTask, "config", 3072, nullptr, 1, nullptr) != pdPASS) { loading.store(false); }
+}
+
+void configLoad() {
+  RuntimeConfig c;
+  if (!loadStored(c)) { return; }
+  RuntimeConfig &next = spare();
+  next = c;
+  active.store(&next, std::memory_order_release);
+}
+
+void configSwap() {
+  RuntimeConfig *next = pending.exchange(nullptr, std::memory_order_acq_rel);
+  if (!next) { return; }
+  active.store(next, std::memory_order_release);
+  if (DEBUG) {Serial.println("Config applied");}
+}
+
+bool configSet(const char *name, uint32_t value) {
+  if (loading.load(std::memory_order_acquire) || value > UINT16_MAX) { return false; }
+  RuntimeConfig *staged = pending.load(std::memory_order_acquire);
+  RuntimeConfig c = staged ? *staged : configActive();
+  if (strcmp(name, "steps") == 0)         { c.numSteps = value > NUM_OF_STEPS ? 0 : value; }
+  else if (strcmp(name, "debounce") == 0) { c.debounceDelay = value; }
+  else if (strcmp(name, "hold") == 0)     { c.holdDelay = value; }
+  else if (strcmp(name, "step") == 0)     { c.stepDelay = value; }
+  else if (strcmp(name, "clear") == 0)    { c.clearStepDelay = value; }
+  else { return false; }
+  if (!configValid(c)) { return false; }
+  stage(c);
+  return true;
+}
+
+void configReset() {
+  if (loading.load(std::memory_order_acquire)) { return; }
+  stage(showConfig);
+}
+
+void configSave() {
+  StoredConfig stored = {};
+  stored.config = configActive();
+  stored.crc = storedCrc(stored);
+  Preferences prefs;
+  prefs.begin("config", false);
+  prefs.putBytes("timing", &stored, sizeof(stored));
+  prefs.end();
+}
+
+void reportConfig() {
+  const RuntimeConfig &c = configActive();
+  Serial.print("steps ");    Serial.println(c.numSteps);
+  Serial.print("debounce "); Serial.println(c.debounceDelay);
+  Serial.print("hold ");     Serial.println(c.holdDelay);
+  Serial.print("step ");     Serial.println(c.stepDelay);
+  Serial.print("clear ");    Serial.println(c.clearStepDelay);
+  if (USE_FRAME_TABLES) {Serial.println(frameTablesMatch(c) ? "Frame tables: in use" : "Frame tables: bypassed, config differs from the show");}
+  if (pending.load(std::memory_order_acquire)) { Serial.println("Changes staged for the next frame"); }
+}
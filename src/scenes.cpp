@@ -0,0 +1,108 @@
+#include <Arduino.h>
+
+#include "config.h"
+#include "output.h"
+#include "scenes.h"
+
+uint8_t sceneCurrent = NO_SCENE;
+
+namespace {
+
+struct ActiveFade {
+  uint16_t channel;
+  uint8_t  from;
+  uint8_t  to;
+  uint32_t startMillis;
+  uint16_t duration;
+};
+
+uint8_t levels[show::dmxSlots + 1] = {};
+ActiveFade fades[show::dmxSlots];
+uint16_t fadeSlot[show::dmxSlots + 1] = {};   // 1 + index into fades per channel, 0 if none
+uint16_t numFades = 0;
+
+void setLevel(uint16_t channel, uint8_t value) {
+  if (value == levels[channel]) { return; }
+  levels[channel] = value;
+  outputScene(channel, value);
+}
+
+void removeFade(uint16_t channel) {
+  if (fadeSlot[channel] == 0) { return; }
+  uint16_t slot = fadeSlot[channel] - 1;
+  fades[slot] = fades[--numFades];
+  fadeSlot[fades[slot].channel] = slot + 1;
+  fadeSlot[channel] = 0;
+}
+
+// Starts (or restarts) a fade from the channel's current level to target.
+void retarget(uint16_t channel, uint8_t target, uint16_t duration, uint32_t now) {
+  if (levels[channel] == target || duration == 0) {
+    removeFade(channel);
+    setLevel(channel, target);
+    return;
+  }
+  if (fadeSlot[channel] == 0) { fadeSlot[channel] = ++numFades; }
+  fades[fadeSlot[channel] - 1] = {channel, levels[channel], target, now, duration};
+}
+
+}  // namespace
+
+uint8_t sceneFind(const char *name) {
+  for (uint8_t i = 0; i < show::numScenes; i++) {
+    if (strcmp(name, show::scenes[i].name) == 0) { return i; }
+  }
+  return NO_SCENE;
+}
+
+void sceneGo(uint8_t scene) {
+  if (scene >= show::numScenes) { return; }
+  uint32_t now = millis();
+  sceneRender(now);   // bring fading channels to their level at the moment of the cut
+
+  const show::Scene &to = show::scenes[scene];
+  // Everything of the outgoing look heads to 0 unless the new scene cues it.
+  for (uint16_t i = numFades; i-- > 0;) {
+    retarget(fades[i].channel, 0, to.fadeMillis, now);
+  }
+  if (sceneCurrent != NO_SCENE) {
+    const show::Scene &from = show::scenes[sceneCurrent];
+    for (uint16_t i = from.firstCue; i < from.firstCue + from.cueCount; i++) {
+      retarget(show::sceneCues[i].channel, 0, to.fadeMillis, now);
+    }
+  }
+  for (uint16_t i = to.firstCue; i < to.firstCue + to.cueCount; i++) {
+    const show::SceneCue &cue = show::sceneCues[i];
+    retarget(cue.channel, cue.value, cue.fadeMillis ? cue.fadeMillis : to.fadeMillis, now);
+  }
+
+  sceneCurrent = scene;
+  if (DEBUG) {Serial.print("Scene: "); Serial.print(to.name); Serial.print(", fading "); Serial.println(numFades);}
+}
+
+void sceneCut(uint8_t scene) {
+  if (scene >= show::numScenes) { return; }
+  const show::Scene &to = show::scenes[scene];
+  for (uint16_t i = to.firstCue; i < to.firstCue + to.cueCount; i++) {
+    setLevel(show::sceneCues[i].channel, show::sceneCues[i].value);
+  }
+  sceneCurrent = scene;
+}
+
+void sceneRender(uint32_t now) {
+  for (uint16_t i = numFades; i-- > 0;) {
+    const ActiveFade &fade = fades[i];
+    uint32_t elapsed = now - fade.startMillis;
+    if (elapsed >= fade.duration) {
+      uint16_t channel = fade.channel;
+      setLevel(channel, fade.to);
+      removeFade(channel);
+      continue;
+    }
+    setLevel(fade.channel, fade.from + ((int32_t)fade.to - fade.from) * (int32_t)elapsed / fade.duration);
+  }
+}
+
+uint16_t sceneActiveFades() {
+  return numFades;
+}
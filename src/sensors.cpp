@@ -0,0 +1,246 @@
+#include <Arduino.h>
+#include <soc/gpio_struct.h>
+#include <atomic>
+
+#include "config.h"
+#include "effects.h"
+#include "runtime_config.h"
+#include "sensors.h"
+
+namespace {
+
+struct SensorInput {
+  uint8_t pin;
+  uint8_t role;
+  uint8_t index;   // wave direction for an end, step number otherwise
+};
+
+constexpr SensorInput bank[] = {SENSOR_BANK};
+constexpr uint8_t numInputs = sizeof(bank) / sizeof(bank[0]);
+
+constexpr uint64_t buildBankMask() {
+  uint64_t mask = 0;
+  for (const SensorInput &input : bank) { mask |= 1ULL << input.pin; }
+  return mask;
+}
+
+constexpr bool pinsValid() {
+  for (uint8_t i = 0; i < numInputs; i++) {
+    if (bank[i].pin > 39) { return false; }
+    for (uint8_t j = 0; j < i; j++) { if (bank[j].pin == bank[i].pin) { return false; } }
+  }
+  return true;
+}
+
+constexpr uint64_t bankMask = buildBankMask();
+
+static_assert(pinsValid(), "sensor bank pins must be distinct GPIOs 0-39");
+static_assert(SENSOR_FILTER_WINDOW <= 31, "vote counters are five bit planes");
+static_assert(SENSOR_FILTER_VOTES * 2 > SENSOR_FILTER_WINDOW && SENSOR_FILTER_VOTES <= SENSOR_FILTER_WINDOW,
+              "votes must be a majority of the window");
+
+#define PLANES 5
+
+struct Sensor {
+  uint8_t  level;           // filtered level, as last seen by sensorsPoll()
+  uint8_t  health;
+  uint32_t levelMillis;     // last level change
+  uint32_t triggerMillis;   // last accepted trigger
+  uint16_t otherTriggers;   // end sensors: triggers at another end since the last level change
+  uint8_t  cleanTriggers;   // flagged sensors: rising edges in a row at least SENSOR_RECOVERY_GAP apart
+};
+
+Sensor sensors[numInputs] = {};
+uint8_t pinInput[40] = {};   // bank index per GPIO
+
+// ---- Sample filter, run from the timer interrupt ----
+
+struct SensorEvent {
+  uint64_t changed;   // GPIO bits whose filtered level changed
+  uint64_t levels;    // filtered levels after the change
+  uint32_t millis;
+};
+
+/**
+ * Every input is filtered at once, bit-sliced over the 40 GPIO bits: the
+ * last SENSOR_FILTER_WINDOW samples are kept as whole register words and
+ * each input's high-sample count as a binary number spread over PLANES
+ * words. A sample is one add/subtract across the planes and two constant
+ * comparisons, so 32 inputs cost the same as 2.
+ */
+DRAM_ATTR uint64_t window[SENSOR_FILTER_WINDOW] = {};
+DRAM_ATTR uint64_t planes[PLANES] = {};
+DRAM_ATTR uint64_t filtered = 0;
+DRAM_ATTR uint8_t windowPos = 0;
+DRAM_ATTR SensorEvent events[SENSOR_EVENT_QUEUE];
+std::atomic<uint8_t> eventHead{0};   // written by the interrupt
+std::atomic<uint8_t> eventTail{0};   // written by sensorsPoll()
+volatile uint16_t eventsDropped = 0;
+hw_timer_t *sampleTimer = nullptr;
+
+inline uint64_t IRAM_ATTR readInputs() {
+  return ((uint64_t)GPIO.in1.data << 32 | GPIO.in) & bankMask;
+}
+
+// Bits whose count is at least n; n is a constant, so the branches fold away.
+inline uint64_t IRAM_ATTR countAtLeast(uint8_t n) {
+  uint64_t greater = 0;
+  uint64_t equal = ~0ULL;
+  for (int8_t p = PLANES - 1; p >= 0; p--) {
+    if (n >> p & 1) { equal &= planes[p]; }
+    else { greater |= equal & planes[p]; equal &= ~planes[p]; }
+  }
+  return greater | equal;
+}
+
+void IRAM_ATTR sampleInputs() {
+  uint64_t raw = readInputs();
+  uint64_t out = window[windowPos];
+  window[windowPos] = raw;
+  if (++windowPos == SENSOR_FILTER_WINDOW) { windowPos = 0; }
+
+  // count += raw - out, carries and borrows rippling through the planes.
+  uint64_t carry = raw & ~out;
+  uint64_t borrow = out & ~raw;
+  for (uint8_t p = 0; p < PLANES; p++) {
+    uint64_t plane = planes[p];
+    planes[p] = plane ^ carry ^ borrow;
+    carry &= plane;
+    borrow &= ~plane;
+  }
+
+  uint64_t high = countAtLeast(SENSOR_FILTER_VOTES);
+  uint64_t notLow = countAtLeast(SENSOR_FILTER_WINDOW - SENSOR_FILTER_VOTES + 1);
+  uint64_t next = high | (filtered & notLow);
+  uint64_t changed = next ^ filtered;
+  if (!changed) { return; }
+
+  // When the queue is full the change is left pending and found again next sample.
+  uint8_t head = eventHead.load(std::memory_order_relaxed);
+  uint8_t nextHead = (head + 1) % SENSOR_EVENT_QUEUE;
+  if (nextHead == eventTail.load(std::memory_order_acquire)) { eventsDropped++; return; }
+  filtered = next;
+  events[head] = {changed, next, millis()};
+  eventHead.store(nextHead, std::memory_order_release);
+}
+
+// ---- Health ----
+
+const char *healthName(uint8_t health) {
+  return health == SENSOR_STUCK_HIGH ? "stuck high" : health == SENSOR_STUCK_LOW ? "stuck low" : "ok";
+}
+
+const char *roleName(uint8_t role) {
+  return role == SENSOR_END ? "end" : role == SENSOR_LANDING ? "landing" : "step";
+}
+
+void setHealth(uint8_t i, uint8_t health) {
+  if (health == sensors[i].health) { return; }
+  sensors[i].health = health;
+  sensors[i].cleanTriggers = 0;
+  if (DEBUG) {Serial.print("Sensor "); Serial.print(i + 1); Serial.print(": "); Serial.println(healthName(health));}
+}
+
+// Stuck low only means something for the ends, which see every walker.
+void checkStuck(uint8_t i, uint32_t now) {
+  const Sensor &s = sensors[i];
+  int32_t held = now - s.levelMillis;   // an event may be newer than now
+  if (held < 0) { return; }
+  if (s.level == HIGH && held >= SENSOR_STUCK_HIGH_TIME) { setHealth(i, SENSOR_STUCK_HIGH); }
+  if (bank[i].role == SENSOR_END && s.level == LOW && held >= SENSOR_STUCK_LOW_TIME &&
+      s.otherTriggers >= SENSOR_STUCK_LOW_TRIGGERS) {
+    setHealth(i, SENSOR_STUCK_LOW);
+  }
+}
+
+// A flagged sensor counts again only after SENSOR_RECOVERY_TRIGGERS clean triggers: rising
+// edges each at least SENSOR_RECOVERY_GAP after the level before them. A sooner one is
+// chatter, as from a half-blocked beam, and restarts the count.
+void recover(uint8_t i, uint8_t level, uint32_t millis) {
+  Sensor &s = sensors[i];
+  if (level != HIGH) { return; }
+  if (millis - s.levelMillis < SENSOR_RECOVERY_GAP) { s.cleanTriggers = 0; return; }
+  if (++s.cleanTriggers < SENSOR_RECOVERY_TRIGGERS) { return; }
+  s.cleanTriggers = 0;
+  setHealth(i, SENSOR_OK);
+}
+
+void onEdge(uint8_t i, uint8_t level, uint32_t millis, void (*onTrigger)(uint8_t role, uint8_t index)) {
+  Sensor &s = sensors[i];
+  bool flagged = s.health != SENSOR_OK;
+  if (flagged) { recover(i, level, millis); }
+  s.level = level;
+  s.levelMillis = millis;
+  s.otherTriggers = 0;
+
+  if (level != HIGH || millis - s.triggerMillis < configActive().debounceDelay) { return; }
+  s.triggerMillis = millis;
+  if (flagged) { return; }   // not even the recovering edge triggers
+  if (bank[i].role == SENSOR_END) {
+    for (uint8_t j = 0; j < numInputs; j++) {
+      if (j != i && bank[j].role == SENSOR_END && sensors[j].otherTriggers < UINT16_MAX) { sensors[j].otherTriggers++; }
+    }
+  }
+  if (DEBUG) {Serial.print("Sensor "); Serial.print(i + 1); Serial.println(" Triggered");}
+  onTrigger(bank[i].role, bank[i].index);
+}
+
+}  // namespace
+
+void sensorsBegin() {
+  for (uint8_t i = 0; i < numInputs; i++) {
+    pinMode(bank[i].pin, INPUT_PULLUP);   // GPIO 34-39 have no pull-up and need external ones
+    pinInput[bank[i].pin] = i;
+  }
+
+  // Start settled on the current levels: already high at boot is not an edge.
+  uint64_t raw = readInputs();
+  for (uint64_t &sample : window) { sample = raw; }
+  for (uint8_t p = 0; p < PLANES; p++) { planes[p] = SENSOR_FILTER_WINDOW >> p & 1 ? raw : 0; }
+  filtered = raw;
+  for (uint8_t i = 0; i < numInputs; i++) {
+    sensors[i].level = raw >> bank[i].pin & 1;
+    sensors[i].levelMillis = millis();
+  }
+
+  sampleTimer = timerBegin(1, 80, true);   // 1 us ticks
+  timerAttachInterrupt(sampleTimer, &sampleInputs, true);
+  timerAlarmWrite(sampleTimer, SENSOR_SAMPLE_INTERVAL, true);
+  timerAlarmEnable(sampleTimer);
+}
+
+void sensorsPoll(uint32_t now, void (*onTrigger)(uint8_t role, uint8_t index)) {
+  uint8_t tail = eventTail.load(std::memory_order_relaxed);
+  while (tail != eventHead.load(std::memory_order_acquire)) {
+    SensorEvent e = events[tail];
+    tail = (tail + 1) % SENSOR_EVENT_QUEUE;
+    eventTail.store(tail, std::memory_order_release);
+
+    // Only the changed bits are visited.
+    for (uint64_t bits = e.changed; bits; bits &= bits - 1) {
+      uint8_t pin = __builtin_ctzll(bits);
+      onEdge(pinInput[pin], e.levels >> pin & 1, e.millis, onTrigger);
+    }
+  }
+  for (uint8_t i = 0; i < numInputs; i++) { checkStuck(i, now); }
+}
+
+bool sensorsSingleMode() {
+  uint8_t ends = 0;
+  uint8_t flagged = 0;
+  for (uint8_t i = 0; i < numInputs; i++) {
+    if (bank[i].role != SENSOR_END) { continue; }
+    ends++;
+    if (sensors[i].health != SENSOR_OK) { flagged++; }
+  }
+  return flagged > 0 && flagged < ends;
+}
+
+void reportSensors() {
+  for (uint8_t i = 0; i < numInputs; i++) {
+    Serial.printf("S%u: GPIO %u %s %u, level %u, %s\n", i + 1, bank[i].pin, roleName(bank[i].role),
+                  bank[i].index, sensors[i].level, healthName(sensors[i].health));
+  }
+  if (sensorsSingleMode()) { Serial.println("Single-sensor mode"); }
+  if (eventsDropped) { Serial.print("Events dropped: "); Serial.println(eventsDropped); }
+}
@@ -0,0 +1,91 @@
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <atomic>
+
+#include "config.h"
+#include "stats.h"
+
+namespace {
+
+TaskHandle_t tasks[STATS_MAX_TASKS] = {};
+uint8_t numTasks = 0;
+
+TaskHandle_t loopTask = nullptr;
+volatile bool armed = false;
+volatile bool paused = false;
+std::atomic<uint32_t> loopAllocations{0};
+std::atomic<uint32_t> otherAllocations{0};
+void *volatile lastCaller = nullptr;
+
+}  // namespace
+
+#if HEAP_GUARD
+
+extern "C" {
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+// Counts an allocation made after setup(); never allocates or prints itself.
+static void IRAM_ATTR guardAllocation(void *caller) {
+  if (!armed) { return; }
+  if (xTaskGetCurrentTaskHandle() != loopTask) { otherAllocations++; return; }
+  if (paused) { return; }
+  loopAllocations++;
+  lastCaller = caller;
+#if HEAP_GUARD_TRAP
+  abort();
+#endif
+}
+
+void *__wrap_malloc(size_t size) {
+  guardAllocation(__builtin_return_address(0));
+  return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+  guardAllocation(__builtin_return_address(0));
+  return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+  guardAllocation(__builtin_return_address(0));
+  return __real_realloc(ptr, size);
+}
+
+}
+
+#endif
+
+void statsRegisterTask(TaskHandle_t task) {
+  if (task && numTasks < STATS_MAX_TASKS) { tasks[numTasks++] = task; }
+}
+
+void statsArm() {
+  loopTask = xTaskGetCurrentTaskHandle();
+  statsRegisterTask(loopTask);
+  armed = true;
+}
+
+void statsPause(bool pause) {
+  paused = pause;
+}
+
+void reportStats() {
+  Serial.print("Heap: free "); Serial.print(ESP.getFreeHeap());
+  Serial.print(", largest block "); Serial.print(heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+  Serial.print(", minimum free "); Serial.println(ESP.getMinFreeHeap());
+  if (HEAP_GUARD) {
+    Serial.print("Allocations after setup: loop "); Serial.print(loopAllocations.load());
+    Serial.print(", other tasks "); Serial.println(otherAllocations.load());
+    if (lastCaller) { Serial.printf("Last loop allocation from 0x%08x\n", (unsigned)(uintptr_t)lastCaller); }
+  } else {
+    Serial.println("Allocations: not instrumented, build with HEAP_GUARD");
+  }
+  for (uint8_t i = 0; i < numTasks; i++) {
+    Serial.print("Stack "); Serial.print(pcTaskGetName(tasks[i]));
+    Serial.print(": "); Serial.print(uxTaskGetStackHighWaterMark(tasks[i]));
+    Serial.println(" bytes free at peak");
+  }
+}
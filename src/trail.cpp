@@ -0,0 +1,117 @@
+#include <Arduino.h>
+#include <algorithm>
+
+#include "config.h"
+#include "effects.h"
+#include "trail.h"
+
+namespace {
+
+struct Walker {
+  uint8_t  direction;     // WAVE_NONE when the slot is free
+  uint32_t startMillis;
+  int16_t  lo;            // lit window in lighting order, empty when lo > hi
+  int16_t  hi;
+};
+
+Walker walkers[TRAIL_MAX_WALKERS] = {};
+uint8_t cover[NUM_OF_STEPS + 1] = {};        // walkers lighting each step
+uint8_t trail[NUM_OF_STEPS + 1] = {};
+uint8_t numSteps = 0;                        // steps the walkers were placed on, 0 before the first
+uint32_t traversalMillis = 0;                // learned walking time, 0 until the first arrival
+uint32_t entryMillis[2] = {};                // last unmatched entry per direction
+bool entryPending[2] = {};
+uint8_t activeWalkers = 0;
+
+// Learned traversal time, or the wave's own pace until a walker has arrived.
+uint32_t traversal(const RuntimeConfig &cfg) {
+  if (traversalMillis) { return traversalMillis; }
+  return std::max((uint32_t)cfg.numSteps * cfg.stepDelay, (uint32_t)1);
+}
+
+void coverStep(const RuntimeConfig &cfg, const Walker &w, int16_t order) {
+  uint8_t step = waveStep(cfg, w.direction, order);
+  if (cover[step]++ == 0) { trail[step] = STEP_ON_LEVEL; }
+}
+
+void uncoverStep(const RuntimeConfig &cfg, const Walker &w, int16_t order) {
+  uint8_t step = waveStep(cfg, w.direction, order);
+  if (--cover[step] == 0) { trail[step] = 0; }
+}
+
+// Moves a walker's window, touching only the steps that enter or leave it.
+void moveWindow(const RuntimeConfig &cfg, Walker &w, int16_t lo, int16_t hi) {
+  for (int16_t o = w.lo; o <= w.hi && o < lo; o++) { uncoverStep(cfg, w, o); }
+  for (int16_t o = std::max(w.lo, (int16_t)(hi + 1)); o <= w.hi; o++) { uncoverStep(cfg, w, o); }
+  for (int16_t o = lo; o <= hi && o < w.lo; o++) { coverStep(cfg, w, o); }
+  for (int16_t o = std::max(lo, (int16_t)(w.hi + 1)); o <= hi; o++) { coverStep(cfg, w, o); }
+  w.lo = lo;
+  w.hi = hi;
+}
+
+// Walkers are placed on the active step count. When it changes their windows no longer fit,
+// so they are dropped rather than unwound, and the learned time is for another staircase.
+void syncSteps(const RuntimeConfig &cfg) {
+  if (cfg.numSteps == numSteps) { return; }
+  if (numSteps) {
+    for (Walker &w : walkers) { w.direction = WAVE_NONE; }
+    memset(cover, 0, sizeof(cover));
+    memset(trail, 0, sizeof(trail));
+    activeWalkers = 0;
+    traversalMillis = 0;
+  }
+  numSteps = cfg.numSteps;
+}
+
+}  // namespace
+
+void trailTrigger(uint8_t direction, uint32_t now) {
+  // A trigger at the far end of a recent entry is that walker arriving.
+  syncSteps(configActive());
+  uint8_t arriving = direction == WAVE_UP ? WAVE_DOWN : WAVE_UP;
+  uint32_t walked = now - entryMillis[arriving - 1];
+  if (entryPending[arriving - 1] && walked >= TRAIL_MIN_TRAVERSAL && walked <= TRAIL_MAX_TRAVERSAL) {
+    entryPending[arriving - 1] = false;
+    traversalMillis = (traversal(configActive()) * 3 + walked) / 4;
+    if (DEBUG) {Serial.print("Walker arrived, traversal ms: "); Serial.println(traversalMillis);}
+    return;
+  }
+
+  entryMillis[direction - 1] = now;
+  entryPending[direction - 1] = true;
+  for (Walker &w : walkers) {
+    if (w.direction != WAVE_NONE) { continue; }
+    w = {direction, now, 0, -1};
+    activeWalkers++;
+    return;
+  }
+  if (DEBUG) {Serial.println("Trail: no free walker slot");}
+}
+
+void trailLevels(uint32_t now, uint8_t *levels) {
+  const RuntimeConfig &cfg = configActive();
+  syncSteps(cfg);
+  uint32_t walkMillis = traversal(cfg);
+  for (Walker &w : walkers) {
+    if (w.direction == WAVE_NONE) { continue; }
+    int16_t position = (uint64_t)(now - w.startMillis) * cfg.numSteps / walkMillis;
+    int16_t lo = position - TRAIL_BEHIND;
+    int16_t hi = position + TRAIL_AHEAD;
+    if (lo >= cfg.numSteps) {
+      moveWindow(cfg, w, 0, -1);
+      w.direction = WAVE_NONE;
+      activeWalkers--;
+      continue;
+    }
+    moveWindow(cfg, w, std::max(lo, (int16_t)0), std::min(hi, (int16_t)(cfg.numSteps - 1)));
+  }
+  memcpy(levels, trail, sizeof(trail));
+}
+
+bool trailActive() {
+  return activeWalkers > 0;
+}
+
+uint32_t trailTraversalMillis() {
+  return traversal(configActive());
+}
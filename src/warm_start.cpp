@@ -0,0 +1,75 @@
+#include <Arduino.h>
+#include <esp_system.h>
+#include <rom/crc.h>
+
+#include "config.h"
+#include "warm_start.h"
+
+#define WARM_MAGIC 0x57524D31   // "WRM1"
+
+namespace {
+
+struct WarmSnapshot {
+  uint32_t magic;
+  WarmState state;
+  uint32_t crc;
+};
+
+// Not cleared by the startup code; only trusted once magic and CRC check out.
+RTC_NOINIT_ATTR WarmSnapshot snapshot;
+RTC_NOINIT_ATTR uint32_t snapshotMillis;    // millis() of the last frame
+RTC_NOINIT_ATTR uint8_t restoreCount;       // warm restarts without a stable run in between
+
+bool primed = false;      // snapshot written at least once since boot
+bool stable = false;
+
+uint32_t snapshotCrc() {
+  return crc32_le(0, (const uint8_t *)&snapshot, offsetof(WarmSnapshot, crc));
+}
+
+bool warmReset() {
+  switch (esp_reset_reason()) {
+    case ESP_RST_SW:
+    case ESP_RST_PANIC:
+    case ESP_RST_INT_WDT:
+    case ESP_RST_TASK_WDT:
+    case ESP_RST_WDT:
+    case ESP_RST_BROWNOUT:
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+bool warmRestore(WarmState &state) {
+  if (!WARM_START_ENABLE || !warmReset()) { restoreCount = 0; return false; }
+  if (snapshot.magic != WARM_MAGIC || snapshot.crc != snapshotCrc()) { restoreCount = 0; return false; }
+  // A state that keeps crashing the firmware is not worth resuming.
+  if (restoreCount >= WARM_MAX_RESTORES) { restoreCount = 0; return false; }
+  restoreCount++;
+
+  state = snapshot.state;
+  state.wave.startMillis += millis() - snapshotMillis;   // pick up where the last frame left off
+  return true;
+}
+
+void warmUpdate(uint32_t now, const WaveTrigger &wave, uint8_t mode, uint8_t scene, const uint8_t *levels) {
+  if (!WARM_START_ENABLE) { return; }
+  snapshotMillis = now;
+  if (!stable && now > WARM_STABLE_TIME) { restoreCount = 0; stable = true; }
+
+  WarmState &s = snapshot.state;
+  if (primed && s.wave.direction == wave.direction && s.wave.startMillis == wave.startMillis &&
+      s.wave.holdElapsed == wave.holdElapsed && s.mode == mode && s.scene == scene &&
+      memcmp(s.levels, levels, sizeof(s.levels)) == 0) { return; }
+
+  s.wave = wave;
+  s.mode = mode;
+  s.scene = scene;
+  memcpy(s.levels, levels, sizeof(s.levels));
+  snapshot.magic = WARM_MAGIC;
+  snapshot.crc = snapshotCrc();
+  primed = true;
+}
@@ -0,0 +1,75 @@
+#include <Arduino.h>
+#include <array>
+
+#include "config.h"
+#include "wave_tail.h"
+
+namespace {
+
+// 2^(-i/256) in 1/65536 (entry 0 saturated): the fractional part of a half-life.
+constexpr std::array<uint16_t, 256> buildHalving() {
+  std::array<uint16_t, 256> lut{};
+  double value = 65536;
+  for (uint16_t i = 0; i < 256; i++) {
+    lut[i] = value > 65535 ? 65535 : (uint16_t)(value + 0.5);
+    value *= 0.99729605608547012;   // 2^(-1/256)
+  }
+  return lut;
+}
+
+constexpr auto halving = buildHalving();
+constexpr uint32_t halfLife = WAVE_TAIL_HALF_LIFE ? WAVE_TAIL_HALF_LIFE : 1;   // tailApply is a no-op at 0
+
+uint8_t passed = 0;           // steps fully behind the front
+uint8_t decayFrom = 0;        // first step still above the floor
+uint32_t tailStartMillis = 0;
+uint8_t tailDirection = WAVE_NONE;
+
+// Time into the wave at which the front has fully passed a step, see wavePassed().
+constexpr uint32_t passTime(const RuntimeConfig &c, uint8_t order) {
+  return ((uint32_t)order * 256 + WAVE_EDGE_WIDTH) * c.stepDelay / 256;
+}
+
+// Tail level above the floor, since ms after the front passed the step.
+uint8_t tailAbove(uint32_t since) {
+  uint32_t halvings = since / halfLife;
+  if (halvings >= 8) { return 0; }
+  uint8_t fraction = (since % halfLife) * 256 / halfLife;
+  return ((uint32_t)(STEP_ON_LEVEL - WAVE_TAIL_FLOOR) * halving[fraction] + 32768) >> 16 >> halvings;
+}
+
+}  // namespace
+
+void tailApply(const RuntimeConfig &c, const WaveTrigger &t, uint32_t elapsed, uint8_t *levels) {
+  if (WAVE_TAIL_HALF_LIFE == 0 || WAVE_TAIL_FLOOR >= STEP_ON_LEVEL || t.direction == WAVE_NONE) { return; }
+
+  uint8_t nowPassed = wavePassed(c, elapsed);
+  if (t.startMillis != tailStartMillis || t.direction != tailDirection) {
+    // New or resumed wave: steps already behind the front start settled.
+    tailStartMillis = t.startMillis;
+    tailDirection = t.direction;
+    decayFrom = nowPassed;
+  }
+  passed = nowPassed;
+
+  // Decaying steps follow the time since the front passed them, whatever the frame rate.
+  for (uint8_t order = decayFrom; order < passed; order++) {
+    uint32_t passAt = passTime(c, order);
+    uint8_t above = tailAbove(elapsed > passAt ? elapsed - passAt : 0);
+    if (above == 0 && order == decayFrom) { decayFrom++; }
+    uint8_t step = waveStep(c, t.direction, order);
+    if (levels[step] > WAVE_TAIL_FLOOR + above) { levels[step] = WAVE_TAIL_FLOOR + above; }
+  }
+  if (decayFrom == 0) { return; }
+
+  // Settled steps are one run of steps at the floor. While the wave holds them
+  // fully lit the floor is written as one block; while clearing they are capped.
+  uint8_t first = t.direction == WAVE_DOWN ? c.numSteps - decayFrom + 1 : 1;
+  if (elapsed < waveClearStart(c, t) && elapsed >= stepOnTime(c, decayFrom - 1) + STEP_FADE_IN) {
+    memset(levels + first, WAVE_TAIL_FLOOR, decayFrom);
+    return;
+  }
+  for (uint8_t step = first; step < first + decayFrom; step++) {
+    if (levels[step] > WAVE_TAIL_FLOOR) { levels[step] = WAVE_TAIL_FLOOR; }
+  }
+}
@@ -0,0 +1,37 @@
+/**
+ * Minimal Arduino API for the native test env: only what the host-built
+ * modules in platformio.ini's build_src_filter use. Time comes from the
+ * host's steady clock, Serial prints to stdout.
+ */
+
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+inline uint32_t micros() {
+  static const auto start = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+inline uint32_t millis() {
+  return micros() / 1000;
+}
+
+struct NativeSerial {
+  void print(const char *text) { fputs(text, stdout); }
+  void print(int value) { printf("%d", value); }
+  void print(unsigned value) { printf("%u", value); }
+  void print(long value) { printf("%ld", value); }
+  void print(unsigned long value) { printf("%lu", value); }
+  void print(double value, int digits = 2) { printf("%.*f", digits, value); }
+  template <typename T> void println(T value) { print(value); println(); }
+  void println() { putchar('\n'); }
+};
+
+inline NativeSerial Serial;
+
+#endif
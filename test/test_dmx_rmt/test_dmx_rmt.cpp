@@ -0,0 +1,111 @@
+/**
+ * RMT DMX encoder against a hand-written reference bitstream, then against
+ * the bit-by-bit reference waveform for random and worst-case packets.
+ *
+ *     pio test -e native -f test_dmx_rmt
+ */
+
+#include <unity.h>
+#include <random>
+#include <vector>
+
+#include "DmxRmtEncoder.h"
+
+namespace {
+
+const uint8_t twoSlots[] = {0x00, 0x01};
+
+// Break 2, MAB 1, then per slot start bit, eight data bits LSB first, two stop bits.
+const char twoSlotsBits[] = "00" "1" "0" "00000000" "11" "0" "10000000" "11";
+
+uint32_t item(uint16_t ticks0, uint8_t level0, uint16_t ticks1, uint8_t level1) {
+  return (ticks0 | (uint32_t)level0 << 15) | (ticks1 | (uint32_t)level1 << 15) << 16;
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_reference_bitstream() {
+  const DmxRmtTiming t = {2, 1, 1};
+  for (uint32_t tick = 0; tick < sizeof(twoSlotsBits) - 1; tick++) {
+    TEST_ASSERT_EQUAL_UINT8(twoSlotsBits[tick] - '0', dmxReferenceLevel(twoSlots, 2, t, tick));
+  }
+  TEST_ASSERT_EQUAL_UINT8(1, dmxReferenceLevel(twoSlots, 2, t, sizeof(twoSlotsBits) - 1));   // idle mark
+}
+
+void test_known_items() {
+  // Runs: break 88 low, MAB 12 high, slot 0 36 low / 8 high, slot 1 4 low, 4 high, 28 low, 8 high.
+  const DmxRmtTiming t = {88, 12, 4};
+  const uint32_t expected[] = {item(88, 0, 12, 1), item(36, 0, 8, 1), item(4, 0, 4, 1), item(28, 0, 8, 1), 0};
+  uint32_t items[dmxRmtItems(2)];
+  size_t count = DmxRmtEncoder(items, dmxRmtItems(2)).encode(twoSlots, 2, t);
+  TEST_ASSERT_EQUAL(5, count);
+  for (size_t i = 0; i < count; i++) { TEST_ASSERT_EQUAL_UINT32(expected[i], items[i]); }
+  TEST_ASSERT_TRUE(dmxRmtVerify(items, count, twoSlots, 2, t));
+}
+
+void test_random_packets() {
+  const DmxRmtTiming t = {88, 12, 4};
+  std::mt19937 rng(1);
+  std::vector<uint32_t> items(dmxRmtItems(513));
+  std::vector<uint8_t> packet(513);
+  for (int round = 0; round < 500; round++) {
+    uint16_t size = 1 + rng() % 513;
+    for (uint8_t &b : packet) {
+      int pattern = round % 5;
+      b = pattern == 0 ? rng() & 0xFF : pattern == 1 ? 0x00 : pattern == 2 ? 0xFF : pattern == 3 ? 0x55 : 0xAA;
+    }
+    packet[0] = 0;
+    size_t count = DmxRmtEncoder(items.data(), dmxRmtItems(size)).encode(packet.data(), size, t);
+    TEST_ASSERT_TRUE(count > 0 && count <= dmxRmtItems(size));
+    TEST_ASSERT_TRUE(dmxRmtVerify(items.data(), count, packet.data(), size, t));
+  }
+}
+
+void test_verify_catches_errors() {
+  const DmxRmtTiming t = {88, 12, 4};
+  uint32_t items[dmxRmtItems(2)];
+  size_t count = DmxRmtEncoder(items, dmxRmtItems(2)).encode(twoSlots, 2, t);
+  items[2] ^= 1 << 15;   // one run at the wrong level
+  TEST_ASSERT_FALSE(dmxRmtVerify(items, count, twoSlots, 2, t));
+  items[2] ^= 1 << 15;
+  items[1] += 1;         // one run a tick too long
+  TEST_ASSERT_FALSE(dmxRmtVerify(items, count, twoSlots, 2, t));
+}
+
+void test_capacity_overflow() {
+  const DmxRmtTiming t = {88, 12, 4};
+  const uint8_t alternating[] = {0x00, 0x55, 0x55, 0x55};
+  uint32_t items[dmxRmtItems(4)];
+  TEST_ASSERT_EQUAL(0, DmxRmtEncoder(items, 4).encode(alternating, 4, t));
+  TEST_ASSERT_TRUE(DmxRmtEncoder(items, dmxRmtItems(4)).encode(alternating, 4, t) > 0);
+}
+
+// One encoder instance, as the engines keep it: a packet that overflows
+// must not affect the next one.
+void test_reuse_after_overflow() {
+  const DmxRmtTiming t = {88, 12, 4};
+  const uint8_t alternating[] = {0x00, 0x55, 0x55, 0x55};
+  const uint8_t twoSlots[] = {0x00, 0xFF};
+  uint32_t items[dmxRmtItems(2)];
+  DmxRmtEncoder encoder(items, dmxRmtItems(2));
+  size_t first = encoder.encode(twoSlots, 2, t);
+  TEST_ASSERT_TRUE(first > 0);
+  TEST_ASSERT_EQUAL(0, encoder.encode(alternating, 4, t));
+  size_t again = encoder.encode(twoSlots, 2, t);
+  TEST_ASSERT_EQUAL(first, again);
+  TEST_ASSERT_TRUE(dmxRmtVerify(items, again, twoSlots, 2, t));
+}
+
+int main(int, char **) {
+  UNITY_BEGIN();
+  RUN_TEST(test_reference_bitstream);
+  RUN_TEST(test_known_items);
+  RUN_TEST(test_random_packets);
+  RUN_TEST(test_verify_catches_errors);
+  RUN_TEST(test_capacity_overflow);
+  RUN_TEST(test_reuse_after_overflow);
+  return UNITY_END();
+}
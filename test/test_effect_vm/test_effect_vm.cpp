@@ -0,0 +1,111 @@
+/**
+ * Effect VM checks on the host: overflowing arithmetic stays defined, the
+ * frame budget holds, and the builtins' instructions per second.
+ *
+ *     pio test -e native -f test_effect_vm
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <chrono>
+
+#include "config.h"
+#include "effect_vm.h"
+
+namespace {
+
+// r1 = -32768 * -32768 * 2 = INT32_MIN after wrapping.
+const VmInstr minProgram[] = {
+  {VM_LDI,    1, 0x00, 0x80},
+  {VM_MUL,    1, 1, 1},
+  {VM_LDI,    2, 2, 0},
+  {VM_MUL,    1, 1, 2},
+};
+
+// Runs prefix + tail and returns the level written to step 1, 0 if the program is rejected.
+uint8_t runWith(const VmInstr *tail, uint8_t length) {
+  VmInstr code[VM_MAX_PROGRAM];
+  uint8_t n = 0;
+  for (const VmInstr &i : minProgram) { code[n++] = i; }
+  for (uint8_t i = 0; i < length; i++) { code[n++] = tail[i]; }
+  if (!vmLoad(code, n)) { return 0; }
+  uint8_t levels[NUM_OF_STEPS + 1] = {};
+  vmRun(levels);
+  vmUnload();
+  return levels[1];
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_overflow_wraps() {
+  // INT32_MIN - 1 wraps to INT32_MAX, which clamps to full level.
+  const VmInstr tail[] = {
+    {VM_LDI,    2, 1, 0},
+    {VM_SUB,    1, 1, 2},
+    {VM_OUT,    1, 0, 0},
+  };
+  TEST_ASSERT_EQUAL_UINT8(255, runWith(tail, 3));
+}
+
+void test_divide_min_by_minus_one() {
+  // INT32_MIN / -1 stays INT32_MIN: negative, so the skip is taken.
+  const VmInstr tail[] = {
+    {VM_LDI,    2, 0xFF, 0xFF},
+    {VM_DIV,    1, 1, 2},
+    {VM_LDI,    3, 0, 0},
+    {VM_LDI,    4, 200, 0},
+    {VM_SKIPLT, 1, 1, 3},
+    {VM_LDI,    4, 100, 0},
+    {VM_OUT,    4, 0, 0},
+  };
+  TEST_ASSERT_EQUAL_UINT8(200, runWith(tail, 7));
+}
+
+void test_blend_extremes() {
+  // Blending from INT32_MIN to 0 at 255/255 lands on 0 without overflowing.
+  const VmInstr tail[] = {
+    {VM_LDI,    2, 0, 0},
+    {VM_LDI,    3, 255, 0},
+    {VM_BLEND,  3, 1, 2},
+    {VM_LDI,    4, 77, 0},
+    {VM_ADD,    3, 3, 4},
+    {VM_OUT,    3, 0, 0},
+  };
+  TEST_ASSERT_EQUAL_UINT8(77, runWith(tail, 6));
+}
+
+void test_frame_budget() {
+  for (uint8_t b = 0; b < vmNumBuiltins; b++) {
+    TEST_ASSERT_TRUE(vmLoad(vmBuiltins[b].code, vmBuiltins[b].length));
+    uint8_t levels[NUM_OF_STEPS + 1] = {};
+    TEST_ASSERT_LESS_OR_EQUAL(VM_FRAME_BUDGET, vmRun(levels));
+  }
+  vmUnload();
+}
+
+void test_benchmark_builtins() {
+  uint8_t levels[NUM_OF_STEPS + 1] = {};
+  for (uint8_t b = 0; b < vmNumBuiltins; b++) {
+    vmLoad(vmBuiltins[b].code, vmBuiltins[b].length);
+    uint64_t executed = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < 100000; frame++) { executed += vmRun(levels); }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("VM %s: %.1f M instr/s, %.0f ns/frame\n", vmBuiltins[b].name, executed / seconds / 1e6,
+           seconds * 1e9 / 100000);
+  }
+  vmUnload();
+}
+
+int main(int, char **) {
+  UNITY_BEGIN();
+  RUN_TEST(test_overflow_wraps);
+  RUN_TEST(test_divide_min_by_minus_one);
+  RUN_TEST(test_blend_extremes);
+  RUN_TEST(test_frame_budget);
+  RUN_TEST(test_benchmark_builtins);
+  return UNITY_END();
+}
@@ -0,0 +1,58 @@
+/**
+ * Checks the wave functions in effects.h against the compiled show's timing.
+ *
+ *     pio test -e native -f test_effects
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "config.h"
+#include "effects.h"
+
+void setUp() {}
+void tearDown() {}
+
+// A re-trigger at any point of the clearing keeps every still-lit step at
+// least as bright as it was, on the resume frame and on every frame after it.
+void test_resume_keeps_lit_steps() {
+  const RuntimeConfig &c = showConfig;
+  for (uint8_t direction = WAVE_UP; direction <= WAVE_DOWN; direction++) {
+    const WaveTrigger t = {direction, 100000, 0};
+    for (uint32_t elapsed = waveClearStart(c, t); elapsed < waveEndTime(c, t); elapsed += FRAME_UPDATE_DELAY) {
+      uint8_t lit = c.numSteps - waveClearedCount(c, t, elapsed);
+      const WaveTrigger resumed = waveResume(c, t, elapsed);
+      uint32_t now = t.startMillis + elapsed;
+      TEST_ASSERT_EQUAL(direction, resumed.direction);
+      for (uint8_t order = 0; order < lit; order++) {
+        uint8_t step = waveStep(c, direction, order);
+        uint8_t before = waveLevel(c, t, step, elapsed);
+        for (uint32_t later = 0; later <= waveLitTime(c); later += FRAME_UPDATE_DELAY) {
+          uint8_t after = waveLevel(c, resumed, step, now + later - resumed.startMillis);
+          TEST_ASSERT_TRUE_MESSAGE(after >= before, "lit step dimmed after a resume");
+        }
+      }
+      TEST_ASSERT_TRUE(wavePhase(c, resumed, now - resumed.startMillis) <= PHASE_HOLDING);
+    }
+  }
+}
+
+// Lit steps are already at full level on the resume frame.
+void test_resume_lit_steps_full() {
+  const RuntimeConfig &c = showConfig;
+  const WaveTrigger t = {WAVE_UP, 0, 0};
+  uint32_t elapsed = waveClearStart(c, t) + c.clearStepDelay / 2;   // the top step fading out
+  const WaveTrigger resumed = waveResume(c, t, elapsed);
+  uint8_t lit = c.numSteps - waveClearedCount(c, t, elapsed);
+  TEST_ASSERT_EQUAL(c.numSteps - 1, lit);
+  for (uint8_t order = 0; order < lit; order++) {
+    TEST_ASSERT_EQUAL(STEP_ON_LEVEL, waveLevelAt(c, resumed, order, elapsed - resumed.startMillis));
+  }
+}
+
+int main(int, char **) {
+  UNITY_BEGIN();
+  RUN_TEST(test_resume_keeps_lit_steps);
+  RUN_TEST(test_resume_lit_steps_full);
+  return UNITY_END();
+}
@@ -0,0 +1,89 @@
+/**
+ * Validates the generated show header and the frame tables built from it,
+ * then benchmarks table playback against computing the wave.
+ *
+ *     pio test -e native -f test_show
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "config.h"
+#include "effects.h"
+#include "frame_tables.h"
+
+void setUp() {}
+void tearDown() {}
+
+void test_steps_fit_step_loops() {
+  // Firmware loops run step = 1..NUM_OF_STEPS in uint8_t.
+  TEST_ASSERT_TRUE(show::numSteps >= 1 && show::numSteps <= 254);
+}
+
+void test_patch_within_universe() {
+  bool used[513] = {};
+  for (uint8_t s = 0; s < show::numSteps; s++) {
+    TEST_ASSERT_TRUE(show::patch[s] >= 1);
+    TEST_ASSERT_TRUE(show::patch[s] + show::footprint - 1 <= show::dmxSlots);
+    for (uint16_t c = show::patch[s]; c < show::patch[s] + show::footprint; c++) {
+      TEST_ASSERT_FALSE_MESSAGE(used[c], "steps overlap");
+      used[c] = true;
+    }
+  }
+  for (uint16_t i = 0; i < show::numSceneCues; i++) {
+    TEST_ASSERT_TRUE(show::sceneCues[i].channel >= 1 && show::sceneCues[i].channel <= show::dmxSlots);
+  }
+}
+
+void test_timing_fits_runtime_config() {
+  TEST_ASSERT_EQUAL(show::holdDelay, showConfig.holdDelay);
+  TEST_ASSERT_TRUE(show::fadeInDelay <= show::holdDelay);
+  TEST_ASSERT_TRUE(waveRampTime(showConfig) <= show::holdDelay);
+  TEST_ASSERT_TRUE(show::stepDelay > 0 && show::clearStepDelay > 0 && show::frameDelay > 0);
+}
+
+void test_tables_match_computed_wave() {
+  uint8_t computed[NUM_OF_STEPS + 1];
+  uint8_t table[NUM_OF_STEPS + 1];
+  TEST_ASSERT_TRUE(frameTablesMatch(showConfig));
+  for (uint8_t direction = WAVE_UP; direction <= WAVE_DOWN; direction++) {
+    const WaveTrigger t = {direction, 0, 0};
+    for (uint32_t elapsed = 0; elapsed <= waveEndTime(showConfig, t); elapsed += FRAME_UPDATE_DELAY) {
+      waveLevels(showConfig, t, elapsed, computed);
+      tableWaveLevels(showConfig, t, elapsed, table);
+      TEST_ASSERT_EQUAL_UINT8_ARRAY(computed + 1, table + 1, NUM_OF_STEPS);
+    }
+  }
+}
+
+void test_benchmark_tables() {
+  uint8_t levels[NUM_OF_STEPS + 1];
+  uint32_t frames = 0;
+  uint32_t computedMicros = 0;
+  uint32_t tableMicros = 0;
+  for (uint16_t round = 0; round < 1000; round++) {
+    for (uint8_t direction = WAVE_UP; direction <= WAVE_DOWN; direction++) {
+      const WaveTrigger t = {direction, 0, 0};
+      uint32_t end = waveEndTime(showConfig, t);
+      uint32_t start = micros();
+      for (uint32_t elapsed = 0; elapsed <= end; elapsed += FRAME_UPDATE_DELAY) { waveLevels(showConfig, t, elapsed, levels); }
+      computedMicros += micros() - start;
+      start = micros();
+      for (uint32_t elapsed = 0; elapsed <= end; elapsed += FRAME_UPDATE_DELAY) { tableWaveLevels(showConfig, t, elapsed, levels); }
+      tableMicros += micros() - start;
+      frames += end / FRAME_UPDATE_DELAY + 1;
+    }
+  }
+  printf("Frame tables: %u bytes, computed %.1f ns/frame, table %.1f ns/frame\n", (unsigned)frameTablesFlashBytes(),
+         computedMicros * 1000.0 / frames, tableMicros * 1000.0 / frames);
+}
+
+int main(int, char **) {
+  UNITY_BEGIN();
+  RUN_TEST(test_steps_fit_step_loops);
+  RUN_TEST(test_patch_within_universe);
+  RUN_TEST(test_timing_fits_runtime_config);
+  RUN_TEST(test_tables_match_computed_wave);
+  RUN_TEST(test_benchmark_tables);
+  return UNITY_END();
+}
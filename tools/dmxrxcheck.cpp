@@ -0,0 +1,269 @@
+/**
+ * Host check for the UART1 receive engine, lib/SparkFun_DMX_Shield_Library/src/DmxRx.cpp.
+ * The engine is built unchanged against the declarations in tools/host; this
+ * file stands in for the hardware behind them: a 128-byte RX FIFO with the
+ * full-threshold, timeout, break and overflow interrupts, the RX pin's level
+ * and edge interrupt, and a microsecond clock that advances 44 us per byte.
+ * Packets are played into it and the frames receive() hands out are checked,
+ * then breaks, gaps and faults of known size against the signal-quality counters.
+ *
+ *     g++ -O2 -std=c++17 -Itools/host -Ilib/SparkFun_DMX_Shield_Library/src tools/dmxrxcheck.cpp \
+ *         lib/SparkFun_DMX_Shield_Library/src/DmxRx.cpp -o dmxrxcheck
+ *     ./dmxrxcheck
+ *
+ * Prints each mismatch and exits non-zero if there was any.
+ */
+
+#include <cstdio>
+#include <deque>
+
+#include <Arduino.h>
+#include <driver/periph_ctrl.h>
+#include <esp_intr_alloc.h>
+#include <esp_ipc.h>
+#include <hal/gpio_ll.h>
+#include <hal/uart_ll.h>
+
+#include "DmxRx.h"
+
+namespace {
+
+constexpr uint32_t fifoSize = 128;
+constexpr uint32_t byteMicros = 44;   // 11 bits at 250 kbaud
+
+struct Line {
+  std::deque<uint8_t> fifo;
+  uint32_t pending = 0;       // raw interrupt status
+  uint32_t enabled = 0;
+  bool masked = false;        // interrupts held off, as by a long critical section elsewhere
+  bool level = true;          // idle high
+  bool edgeArmed = false;
+  void (*uartIsr)(void *) = nullptr;
+  void (*edgeIsr)(void *) = nullptr;
+  uint32_t now = 1000000;
+
+  void service() {
+    if (!masked && (pending & enabled) && uartIsr) { uartIsr(nullptr); }
+  }
+
+  void push(uint8_t b, uint32_t status = 0) {
+    now += byteMicros;
+    if (fifo.size() >= fifoSize) {
+      pending |= UART_INTR_RXFIFO_OVF;
+    } else {
+      fifo.push_back(b);
+      if (fifo.size() >= DMX_RX_FIFO_TRIGGER) { pending |= UART_INTR_RXFIFO_FULL; }
+    }
+    pending |= status;
+    service();
+  }
+
+  // The line going quiet with bytes left in the FIFO.
+  void quiet() {
+    if (!fifo.empty()) { pending |= UART_INTR_RXFIFO_TOUT; }
+    service();
+  }
+
+  // A break of length us: the UART reports it as a 0 byte with a framing error once
+  // DMX_RX_BREAK_DETECT has passed, then the rising edge ends it, unless it already has.
+  void lineBreak(uint32_t length) {
+    quiet();
+    level = length <= DMX_RX_BREAK_DETECT;
+    now += DMX_RX_BREAK_DETECT - byteMicros;
+    push(0, UART_INTR_BRK_DET | UART_INTR_FRAM_ERR);
+    if (!level) {
+      now += length - DMX_RX_BREAK_DETECT;
+      level = true;
+      if (edgeArmed && edgeIsr) { edgeIsr(nullptr); }
+    }
+    now += 12;   // mark after break
+  }
+
+  // Break, start code, then size - 1 slots of value.
+  void packet(uint16_t size, uint8_t startCode, uint8_t value, uint32_t breakLength = 120) {
+    lineBreak(breakLength);
+    push(startCode);
+    for (uint16_t i = 1; i < size; i++) { push(value); }
+  }
+};
+
+Line line;
+
+}  // namespace
+
+uart_dev_t UART1;
+gpio_dev_t GPIO;
+
+uint32_t micros() { return line.now; }
+uint32_t millis() { return line.now / 1000; }
+void pinMode(uint8_t, uint8_t) {}
+void pinMatrixInAttach(uint8_t, uint8_t, bool) {}
+void periph_module_enable(periph_module_t) {}
+
+int esp_intr_alloc(int, int, void (*handler)(void *), void *, intr_handle_t *) {
+  line.uartIsr = handler;
+  return 0;
+}
+
+int esp_ipc_call_blocking(uint32_t, esp_ipc_func_t func, void *arg) {
+  func(arg);
+  return 0;
+}
+
+int gpio_install_isr_service(int) { return 0; }
+int gpio_set_intr_type(gpio_num_t, gpio_int_type_t type) { line.edgeArmed = type == GPIO_INTR_POSEDGE; return 0; }
+int gpio_isr_handler_add(gpio_num_t, void (*handler)(void *), void *) { line.edgeIsr = handler; return 0; }
+void gpio_ll_set_intr_type(gpio_dev_t *, uint32_t, gpio_int_type_t type) { line.edgeArmed = type == GPIO_INTR_POSEDGE; }
+int gpio_ll_get_level(gpio_dev_t *, uint32_t) { return line.level; }
+
+void uart_ll_set_sclk(uart_dev_t *, uart_sclk_t) {}
+void uart_ll_set_baudrate(uart_dev_t *, uint32_t) {}
+void uart_ll_set_data_bit_num(uart_dev_t *, uart_word_length_t) {}
+void uart_ll_set_parity(uart_dev_t *, uart_parity_t) {}
+void uart_ll_set_stop_bits(uart_dev_t *, uart_stop_bits_t) {}
+void uart_ll_set_rxfifo_full_thr(uart_dev_t *, uint16_t) {}
+void uart_ll_set_rx_tout(uart_dev_t *, uint16_t) {}
+void uart_ll_rxfifo_rst(uart_dev_t *) { line.fifo.clear(); }
+uint32_t uart_ll_get_rxfifo_len(uart_dev_t *) { return line.fifo.size(); }
+uint32_t uart_ll_get_intsts_mask(uart_dev_t *) { return line.pending & line.enabled; }
+void uart_ll_clr_intsts_mask(uart_dev_t *, uint32_t mask) { line.pending &= ~mask; }
+void uart_ll_ena_intr_mask(uart_dev_t *, uint32_t mask) { line.enabled |= mask; }
+void uart_ll_disable_intr_mask(uart_dev_t *, uint32_t mask) { line.enabled &= ~mask; }
+
+void uart_ll_read_rxfifo(uart_dev_t *, uint8_t *buf, uint32_t length) {
+  while (length--) {
+    *buf++ = line.fifo.front();
+    line.fifo.pop_front();
+  }
+}
+
+namespace {
+
+int failures = 0;
+
+void expect(const char *what, uint32_t got, uint32_t want) {
+  if (got != want) {
+    printf("%s: got %u, want %u\n", what, got, want);
+    failures++;
+  }
+}
+
+void checkReceive() {
+  expect("nothing before a frame", dmxRx.receive(), false);
+  expect("size before a frame", dmxRx.size(), 0);
+
+  // A frame is complete at the next break; only the latest is handed out.
+  line.packet(10, 0, 7);
+  line.packet(20, 0, 9);
+  line.lineBreak(120);
+  expect("frame taken", dmxRx.receive(), true);
+  expect("latest size", dmxRx.size(), 20);
+  expect("latest slot", dmxRx.read(5), 9);
+  expect("past the end", dmxRx.read(20), 0);
+  expect("frames", dmxRx.frames(), 2);
+  expect("taken once", dmxRx.receive(), false);
+  expect("kept after", dmxRx.read(19), 9);
+
+  // Full size, then an overlong frame and another start code, both dropped.
+  line.packet(DMX_RX_PACKET_MAX, 0, 3);
+  line.packet(DMX_RX_PACKET_MAX + 1, 0, 4);
+  line.packet(30, 0xCC, 5);
+  line.lineBreak(120);
+  expect("full frame", dmxRx.receive(), true);
+  expect("full size", dmxRx.size(), DMX_RX_PACKET_MAX);
+  expect("last slot", dmxRx.read(512), 3);
+  expect("dropped frames", dmxRx.receive(), false);
+
+  // Interrupts held off past the FIFO's depth: the frame is dropped, the next one is whole.
+  line.lineBreak(120);
+  line.masked = true;
+  for (uint32_t i = 0; i < fifoSize + 8; i++) { line.push(i ? 6 : 0); }
+  line.masked = false;
+  line.service();
+  for (uint16_t i = 0; i < 100; i++) { line.push(6); }
+  line.packet(40, 0, 8);
+  line.lineBreak(120);
+  expect("after an overrun", dmxRx.receive(), true);
+  expect("overrun size", dmxRx.size(), 40);
+  expect("overrun slot", dmxRx.read(39), 8);
+
+  // Buffers are swapped, not copied: a frame read stays intact while later ones arrive.
+  line.packet(50, 0, 1);
+  line.lineBreak(120);
+  dmxRx.receive();
+  line.packet(60, 0, 2);
+  line.packet(70, 0, 3);
+  expect("read during arrivals", dmxRx.read(49), 1);
+  line.lineBreak(120);
+  expect("newest after arrivals", dmxRx.receive() && dmxRx.size() == 70 && dmxRx.read(69) == 3, true);
+
+  printf("Receive: %s\n", failures ? "mismatch" : "frames match");
+}
+
+void checkStats() {
+  int before = failures;
+  DmxRxStats stats;
+
+  // Break lengths: in spec, short, ended before detection, long.
+  line.lineBreak(120);
+  dmxRx.resetStats();
+  line.lineBreak(60);
+  dmxRx.stats(stats);
+  expect("short break", stats.shortBreaks, 1);
+  expect("short length", stats.lastBreak, 60);
+  line.lineBreak(20);
+  dmxRx.stats(stats);
+  expect("break over at detection", stats.shortBreaks, 2);
+  expect("detection length", stats.lastBreak, DMX_RX_BREAK_DETECT);
+  line.lineBreak(2000);
+  line.lineBreak(100);
+  dmxRx.stats(stats);
+  expect("long break", stats.longBreaks, 1);
+  expect("in spec length", stats.lastBreak, 100);
+  expect("short breaks after", stats.shortBreaks, 2);
+
+  // Intervals from break to break: the break, its mark, then the gap.
+  dmxRx.resetStats();
+  const uint32_t gaps[] = {500, 3000, 30000, 30000, 5000000};
+  for (uint32_t gap : gaps) {
+    line.now += gap;
+    line.lineBreak(120);
+  }
+  dmxRx.stats(stats);
+  const uint32_t buckets[DMX_RX_INTERVAL_BUCKETS] = {1, 0, 1, 0, 0, 2, 0, 0, 0, 0, 0, 1};
+  for (uint8_t b = 0; b < DMX_RX_INTERVAL_BUCKETS; b++) { expect("interval bucket", stats.intervals[b], buckets[b]); }
+
+  // Frame counters.
+  dmxRx.resetStats();
+  line.packet(20, 0, 1);
+  line.packet(20, 0, 1);
+  line.packet(30, 0, 1);
+  line.packet(DMX_RX_PACKET_MAX + 1, 0, 1);
+  line.packet(30, 0x17, 1);
+  line.push(1, UART_INTR_FRAM_ERR);
+  line.lineBreak(120);
+  line.masked = true;
+  for (uint32_t i = 0; i < fifoSize + 1; i++) { line.push(0); }
+  line.masked = false;
+  line.lineBreak(120);
+  dmxRx.stats(stats);
+  expect("frames", stats.frames, 3);
+  expect("size changes", stats.sizeChanges, 1);
+  expect("last size", stats.lastSize, 30);
+  expect("oversize", stats.oversize, 1);
+  expect("other start codes", stats.otherStartCodes, 1);
+  expect("framing errors", stats.framingErrors, 1);
+  expect("overruns", stats.overruns, 1);
+  expect("no short breaks", stats.shortBreaks + stats.longBreaks, 0);
+
+  printf("Stats: %s\n", failures > before ? "mismatch" : "counters match");
+}
+
+}  // namespace
+
+int main() {
+  dmxRx.begin(4);
+  checkReceive();
+  checkStats();
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,30 @@
+/**
+ * Host stand-ins for the Arduino and IDF declarations that DmxRx.cpp uses,
+ * so it builds unchanged for tools/dmxrxcheck.cpp. Declarations only: the
+ * check provides the simulated UART, GPIO and clock behind them.
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define INPUT_PULLUP 0x05
+
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux)     (void)(mux)
+#define portEXIT_CRITICAL(mux)      (void)(mux)
+#define portENTER_CRITICAL_ISR(mux) (void)(mux)
+#define portEXIT_CRITICAL_ISR(mux)  (void)(mux)
+
+uint32_t micros();
+uint32_t millis();
+void pinMode(uint8_t pin, uint8_t mode);
+void pinMatrixInAttach(uint8_t pin, uint8_t signal, bool inverted);
+
+#endif
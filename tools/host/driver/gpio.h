@@ -0,0 +1,11 @@
+#ifndef HOST_GPIO_H
+#define HOST_GPIO_H
+
+typedef int gpio_num_t;
+typedef enum { GPIO_INTR_DISABLE, GPIO_INTR_POSEDGE } gpio_int_type_t;
+
+int gpio_install_isr_service(int flags);
+int gpio_set_intr_type(gpio_num_t pin, gpio_int_type_t type);
+int gpio_isr_handler_add(gpio_num_t pin, void (*handler)(void *), void *arg);
+
+#endif
@@ -0,0 +1,7 @@
+#ifndef HOST_PERIPH_CTRL_H
+#define HOST_PERIPH_CTRL_H
+
+typedef enum { PERIPH_UART1_MODULE } periph_module_t;
+void periph_module_enable(periph_module_t module);
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef HOST_ESP_INTR_ALLOC_H
+#define HOST_ESP_INTR_ALLOC_H
+
+typedef void *intr_handle_t;
+#define ESP_INTR_FLAG_IRAM     (1 << 10)
+#define ETS_UART1_INTR_SOURCE  35
+
+int esp_intr_alloc(int source, int flags, void (*handler)(void *), void *arg, intr_handle_t *handle);
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef HOST_ESP_IPC_H
+#define HOST_ESP_IPC_H
+
+#include <stdint.h>
+
+typedef void (*esp_ipc_func_t)(void *);
+int esp_ipc_call_blocking(uint32_t core, esp_ipc_func_t func, void *arg);
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef HOST_GPIO_LL_H
+#define HOST_GPIO_LL_H
+
+#include <stdint.h>
+#include <driver/gpio.h>
+#include <soc/gpio_struct.h>
+
+void gpio_ll_set_intr_type(gpio_dev_t *hw, uint32_t pin, gpio_int_type_t type);
+int gpio_ll_get_level(gpio_dev_t *hw, uint32_t pin);
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef HOST_UART_LL_H
+#define HOST_UART_LL_H
+
+#include <stdint.h>
+
+typedef struct { int unused; } uart_dev_t;
+extern uart_dev_t UART1;
+#define UART_LL_GET_HW(num) (&UART1)
+
+#define UART_LL_INTR_MASK      0x7FFFF
+#define UART_INTR_RXFIFO_FULL  (1 << 0)
+#define UART_INTR_FRAM_ERR     (1 << 3)
+#define UART_INTR_RXFIFO_OVF   (1 << 4)
+#define UART_INTR_BRK_DET      (1 << 7)
+#define UART_INTR_RXFIFO_TOUT  (1 << 8)
+
+typedef enum { UART_SCLK_APB } uart_sclk_t;
+typedef enum { UART_DATA_8_BITS = 3 } uart_word_length_t;
+typedef enum { UART_PARITY_DISABLE } uart_parity_t;
+typedef enum { UART_STOP_BITS_2 = 3 } uart_stop_bits_t;
+
+void uart_ll_set_sclk(uart_dev_t *hw, uart_sclk_t source);
+void uart_ll_set_baudrate(uart_dev_t *hw, uint32_t baud);
+void uart_ll_set_data_bit_num(uart_dev_t *hw, uart_word_length_t bits);
+void uart_ll_set_parity(uart_dev_t *hw, uart_parity_t parity);
+void uart_ll_set_stop_bits(uart_dev_t *hw, uart_stop_bits_t bits);
+void uart_ll_set_rxfifo_full_thr(uart_dev_t *hw, uint16_t threshold);
+void uart_ll_set_rx_tout(uart_dev_t *hw, uint16_t threshold);
+void uart_ll_rxfifo_rst(uart_dev_t *hw);
+uint32_t uart_ll_get_rxfifo_len(uart_dev_t *hw);
+void uart_ll_read_rxfifo(uart_dev_t *hw, uint8_t *buf, uint32_t length);
+uint32_t uart_ll_get_intsts_mask(uart_dev_t *hw);
+void uart_ll_clr_intsts_mask(uart_dev_t *hw, uint32_t mask);
+void uart_ll_ena_intr_mask(uart_dev_t *hw, uint32_t mask);
+void uart_ll_disable_intr_mask(uart_dev_t *hw, uint32_t mask);
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef HOST_GPIO_SIG_MAP_H
+#define HOST_GPIO_SIG_MAP_H
+
+#define U1RXD_IN_IDX 17
+
+#endif
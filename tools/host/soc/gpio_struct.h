@@ -0,0 +1,7 @@
+#ifndef HOST_GPIO_STRUCT_H
+#define HOST_GPIO_STRUCT_H
+
+typedef struct { int unused; } gpio_dev_t;
+extern gpio_dev_t GPIO;
+
+#endif
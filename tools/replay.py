@@ -0,0 +1,256 @@
+#!/usr/bin/env python3
+"""
+Replays frames recorded by the firmware's output recorder (see
+include/recorder.h for the stream format).
+
+The recording is read from a flash image, memory-mapped, so seeking costs
+one header read per block regardless of the ring size:
+
+    esptool.py read_flash 0x290000 0x170000 rec.bin     # default partition table's spiffs partition
+    python3 tools/replay.py rec.bin list
+    python3 tools/replay.py rec.bin play --at 14:32:00 --clock 14:35:10=8123456 --duration 60000
+
+or rebuilt from the serial 'record dump' output:
+
+    python3 tools/replay.py rec.bin undump capture.txt
+
+Commands:
+    list      sessions and blocks with the uptime they cover
+    play      renders each frame as a staircase line of step levels, using the
+              show's patch (--show), in real time or --speed times faster
+    csv       writes millis and every slot per frame, or only --step's channels
+
+Times: --at takes device uptime in ms, or a wall time HH:MM[:SS] together with
+--clock HH:MM[:SS]=UPTIME_MS, one reading of 'record' over serial. The newest
+session is used unless --session picks another.
+"""
+
+import argparse
+import bisect
+import json
+import mmap
+import os
+import re
+import struct
+import sys
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from showc import ShowError, compile_show  # noqa: E402
+
+BLOCK_SIZE = 4096
+MAGIC = 0x31435244
+HEADER = struct.Struct('<IIIHH')
+SHADES = ' .:-=+*#%@'
+
+
+class Block:
+    def __init__(self, offset, sequence, session, slots, header_size, first_millis):
+        self.offset = offset
+        self.sequence = sequence
+        self.session = session
+        self.slots = slots
+        self.header_size = header_size
+        self.first_millis = first_millis
+
+
+def scan(data):
+    """Valid blocks by session, each list in sequence order. Only headers and first keyframes are read."""
+    sessions = {}
+    for offset in range(0, len(data) - BLOCK_SIZE + 1, BLOCK_SIZE):
+        magic, sequence, session, slots, header_size = HEADER.unpack_from(data, offset)
+        if magic != MAGIC:
+            continue
+        start = offset + header_size
+        if data[start] != ord('K'):
+            continue
+        first, = struct.unpack_from('<I', data, start + 1)
+        sessions.setdefault(session, []).append(Block(offset, sequence, session, slots, header_size, first))
+    for blocks in sessions.values():
+        blocks.sort(key=lambda b: b.sequence)
+    return sessions
+
+
+def decode(data, block):
+    """Yields (millis, frame) for every record of a block."""
+    slots = block.slots
+    end = block.offset + BLOCK_SIZE
+    p = block.offset + block.header_size
+    frame = bytearray(slots)
+    millis = 0
+    while p < end and data[p] != 0xFF:
+        kind = data[p]
+        if kind == ord('K'):
+            millis, = struct.unpack_from('<I', data, p + 1)
+            frame[:] = data[p + 5:p + 5 + slots]
+            p += 5 + slots
+        elif kind == ord('D'):
+            dt, = struct.unpack_from('<H', data, p + 1)
+            millis = (millis + dt) & 0xFFFFFFFF
+            p += 3
+            c = 0
+            while c < slots:
+                token = data[p]
+                p += 1
+                if token < 0x80:
+                    c += token + 1
+                    continue
+                for _ in range((token & 0x7F) + 1):
+                    frame[c] ^= data[p]
+                    c += 1
+                    p += 1
+        else:
+            raise ValueError('block %d: bad record type 0x%02x at %d' % (block.sequence, kind, p - block.offset))
+        yield millis, bytes(frame)
+
+
+def frames(data, blocks, start, duration):
+    """Frames from start for duration ms, decoded from the last block that begins at or before start."""
+    i = max(bisect.bisect_right([b.first_millis for b in blocks], start) - 1, 0)
+    before = None   # the frame on the lines at start
+    for block in blocks[i:]:
+        for millis, frame in decode(data, block):
+            if millis < start:
+                before = frame
+                continue
+            if before is not None and millis > start:
+                yield start, before
+            before = None
+            if duration is not None and millis > start + duration:
+                return
+            yield millis, frame
+    if before is not None:
+        yield start, before
+
+
+def parse_clock(text):
+    m = re.fullmatch(r'(\d+):(\d+)(?::(\d+))?', text)
+    if not m:
+        raise ValueError('expected HH:MM[:SS], got %r' % text)
+    h, mi, s = int(m.group(1)), int(m.group(2)), int(m.group(3) or 0)
+    return ((h * 60 + mi) * 60 + s) * 1000
+
+
+def start_millis(args):
+    if args.at is None:
+        return 0
+    if ':' not in args.at:
+        return int(args.at)
+    if not args.clock or '=' not in args.clock:
+        sys.exit('--at with a wall time needs --clock HH:MM[:SS]=UPTIME_MS')
+    wall, uptime = args.clock.split('=')
+    return max(int(uptime) - (parse_clock(wall) - parse_clock(args.at)), 0)
+
+
+def step_levels(frame, show):
+    """Brightest channel of each step's fixture."""
+    footprint = show['footprint']
+    return [max(frame[ch - 1:ch - 1 + footprint]) for ch in show['channels']]
+
+
+def cmd_list(data, sessions, args):
+    for session, blocks in sorted(sessions.items(), key=lambda s: s[1][-1].sequence):
+        last = list(decode(data, blocks[-1]))
+        end = last[-1][0] if last else blocks[-1].first_millis
+        print('session %08x: blocks %d-%d, %d slots, uptime %d-%d ms' % (
+            session, blocks[0].sequence, blocks[-1].sequence, blocks[0].slots, blocks[0].first_millis, end))
+        if args.verbose:
+            for b in blocks:
+                print('  block %6d at 0x%06x from %d ms' % (b.sequence, b.offset, b.first_millis))
+
+
+def cmd_play(data, blocks, args, show):
+    start = start_millis(args)
+    previous = None
+    wall = time.monotonic()
+    for millis, frame in frames(data, blocks, start, args.duration):
+        if previous is not None and args.speed > 0:
+            wall += (millis - previous) / 1000 / args.speed
+            delay = wall - time.monotonic()
+            if delay > 0:
+                time.sleep(delay)
+        previous = millis
+        levels = step_levels(frame, show)
+        line = ''.join(SHADES[level * (len(SHADES) - 1) // 255] for level in levels)
+        print('%10d |%s|' % (millis, line), flush=True)
+
+
+def cmd_csv(data, blocks, args, show):
+    start = start_millis(args)
+    if args.step:
+        if not 1 <= args.step <= show['steps']:
+            sys.exit('--step must be 1..%d' % show['steps'])
+        first = show['channels'][args.step - 1]
+        columns = list(range(first, first + show['footprint']))
+    else:
+        columns = list(range(1, blocks[0].slots + 1))
+    print('millis,' + ','.join('ch%d' % c for c in columns))
+    for millis, frame in frames(data, blocks, start, args.duration):
+        print('%d,%s' % (millis, ','.join(str(frame[c - 1]) for c in columns)))
+
+
+def undump(image, capture):
+    """Writes the blocks of a 'record dump' capture into a flash-image-like file."""
+    blocks = {}
+    with open(capture) as f:
+        for line in f:
+            m = re.match(r'R (\d+) (\d+) ([0-9a-f]+)\s*$', line)
+            if m:
+                chunk = blocks.setdefault(int(m.group(1)), bytearray(b'\xff' * BLOCK_SIZE))
+                offset = int(m.group(2))
+                raw = bytes.fromhex(m.group(3))
+                chunk[offset:offset + len(raw)] = raw
+    with open(image, 'wb') as f:
+        for sequence in sorted(blocks):
+            f.write(blocks[sequence])
+    print('%s: %d blocks' % (image, len(blocks)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Replay frames recorded by the staircase firmware.')
+    parser.add_argument('image', help='flash image of the recorder partition')
+    parser.add_argument('command', choices=('list', 'play', 'csv', 'undump'))
+    parser.add_argument('capture', nargs='?', help='undump: serial capture of "record dump"')
+    parser.add_argument('--show', default=os.path.join(os.path.dirname(__file__), '..', 'shows', 'gitex.json'))
+    parser.add_argument('--session', help='session id in hex, default the newest')
+    parser.add_argument('--at', help='start: uptime ms, or HH:MM[:SS] with --clock')
+    parser.add_argument('--clock', help='HH:MM[:SS]=UPTIME_MS, the wall time at a known uptime')
+    parser.add_argument('--duration', type=int, help='ms to replay after the start')
+    parser.add_argument('--speed', type=float, default=1.0, help='play: replay speed, 0 = as fast as possible')
+    parser.add_argument('--step', type=int, help='csv: only this step\'s channels')
+    parser.add_argument('-v', '--verbose', action='store_true')
+    args = parser.parse_args()
+
+    if args.command == 'undump':
+        if not args.capture:
+            sys.exit('undump needs the capture file')
+        undump(args.image, args.capture)
+        return
+
+    try:
+        with open(args.show) as f:
+            show = compile_show(json.load(f))
+    except (OSError, ValueError, ShowError) as e:
+        sys.exit('%s: %s' % (args.show, e))
+
+    with open(args.image, 'rb') as f, mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ) as data:
+        sessions = scan(data)
+        if not sessions:
+            sys.exit('%s: no recorder blocks' % args.image)
+        if args.command == 'list':
+            cmd_list(data, sessions, args)
+            return
+        if args.session:
+            blocks = sessions.get(int(args.session, 16))
+            if not blocks:
+                sys.exit('no session %s' % args.session)
+        else:
+            blocks = max(sessions.values(), key=lambda b: b[-1].sequence)
+        if args.command == 'play':
+            cmd_play(data, blocks, args, show)
+        else:
+            cmd_csv(data, blocks, args, show)
+
+
+if __name__ == '__main__':
+    main()
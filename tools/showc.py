@@ -0,0 +1,298 @@
+#!/usr/bin/env python3
+"""
+Show compiler for the interactive staircase.
+
+Reads a declarative show description (JSON, see shows/gitex.json) and writes a
+C++ header of constexpr parameters and tables for the firmware, so nothing has
+to be parsed at runtime and a new look is a recompile instead of a code edit.
+
+    python3 tools/showc.py shows/gitex.json include/show.h
+
+Show file keys:
+    name                      free text, copied into the header comment
+    steps                     number of steps (1..254, the firmware counts them in uint8_t loops)
+    timing.debounce_ms        minimum time between sensor triggers
+    timing.frame_ms           render frame period
+    wave.step_ms              delay between steps lighting up
+    wave.hold_ms              time the staircase stays lit after the last trigger (>= fade in and edge time)
+    wave.clear_step_ms        delay between steps clearing
+    wave.fade_in_ms           per-step fade in (0 = switch)
+    wave.fade_out_ms          per-step fade out (0 = switch)
+    wave.level                full level of a lit step
+    wave.edge_steps           width of the anti-aliased wavefront ramp in steps (0 = hard edge)
+    wave.tail.floor           level lit steps settle to behind the front
+    wave.tail.half_life_ms    half-life of the exponential tail (0 = no tail)
+    fixture.footprint         DMX channels per step fixture (1 = dimmer, 4 = RGBW, ...)
+    fixture.colour            one value per footprint channel, scaled by the step level
+    fixture.watts             optional power draw per footprint channel at full level
+    patch.start               first DMX channel; steps are patched consecutively
+    patch.channels            or an explicit start channel per step
+    colours                   optional per-step colour overrides: {"<step>": [...]}
+    power.budget_w            supply budget for all fixtures (0 = no limit)
+    power.other_channel_w     draw of channels outside the step patch at full level
+    power.hysteresis_pct      how far the load may drop below the budget before the limiter relaxes
+    scenes.<name>.fade_ms     default crossfade time into the scene
+    scenes.<name>.cues        sparse [channel, value] or [channel, value, fade_ms] list;
+                              channels not listed fade to 0
+"""
+
+import argparse
+import json
+import sys
+
+DMX_SLOTS = 512
+
+
+class ShowError(Exception):
+    pass
+
+
+def require(show, path, kind=int, minimum=None, maximum=None, default=None):
+    node = show
+    for key in path.split('.'):
+        if not isinstance(node, dict) or key not in node:
+            if default is not None:
+                return default
+            raise ShowError('missing "%s"' % path)
+        node = node[key]
+    if not isinstance(node, kind) or isinstance(node, bool):
+        raise ShowError('"%s" must be %s' % (path, kind.__name__))
+    if minimum is not None and node < minimum:
+        raise ShowError('"%s" must be >= %d' % (path, minimum))
+    if maximum is not None and node > maximum:
+        raise ShowError('"%s" must be <= %d' % (path, maximum))
+    return node
+
+
+def check_colour(colour, footprint, where):
+    if not isinstance(colour, list) or len(colour) != footprint:
+        raise ShowError('%s must list %d values' % (where, footprint))
+    for value in colour:
+        if not isinstance(value, int) or not 0 <= value <= 255:
+            raise ShowError('%s values must be 0..255' % where)
+    return colour
+
+
+def compile_show(show):
+    steps = require(show, 'steps', minimum=1, maximum=254)
+    params = {
+        'debounce': require(show, 'timing.debounce_ms', minimum=0, maximum=65535),
+        'frame': require(show, 'timing.frame_ms', minimum=1, maximum=1000),
+        'step': require(show, 'wave.step_ms', minimum=1, maximum=65535),
+        'hold': require(show, 'wave.hold_ms', minimum=0, maximum=65535),
+        'clear_step': require(show, 'wave.clear_step_ms', minimum=1, maximum=65535),
+        'fade_in': require(show, 'wave.fade_in_ms', minimum=0, maximum=65535, default=0),
+        'fade_out': require(show, 'wave.fade_out_ms', minimum=0, maximum=65535, default=0),
+        'level': require(show, 'wave.level', minimum=1, maximum=255),
+    }
+
+    edge = show.get('wave', {}).get('edge_steps', 0)
+    if not isinstance(edge, (int, float)) or isinstance(edge, bool) or not 0 <= edge <= 16:
+        raise ShowError('"wave.edge_steps" must be a number 0..16')
+    params['edge'] = int(round(edge * 256))
+    params['tail_floor'] = require(show, 'wave.tail.floor', minimum=0, maximum=255, default=0)
+    params['tail_half_life'] = require(show, 'wave.tail.half_life_ms', minimum=0, maximum=65535, default=0)
+
+    if params['fade_in'] > params['hold']:
+        raise ShowError('"wave.fade_in_ms" must not exceed "wave.hold_ms"')
+    if (params['edge'] * params['step'] + 255) // 256 > params['hold']:
+        raise ShowError('the edge time, "wave.edge_steps" x "wave.step_ms", must not exceed "wave.hold_ms"')
+
+    footprint = require(show, 'fixture.footprint', minimum=1, maximum=DMX_SLOTS)
+    base_colour = check_colour(show.get('fixture', {}).get('colour'), footprint, 'fixture.colour')
+
+    watts = show.get('fixture', {}).get('watts', [0] * footprint)
+    if not isinstance(watts, list) or len(watts) != footprint or \
+            not all(isinstance(v, (int, float)) and not isinstance(v, bool) and 0 <= v <= 65 for v in watts):
+        raise ShowError('fixture.watts must list %d values of 0..65 W' % footprint)
+
+    patch = show.get('patch', {})
+    if 'channels' in patch:
+        channels = patch['channels']
+        if not isinstance(channels, list) or len(channels) != steps:
+            raise ShowError('patch.channels must list %d channels' % steps)
+    else:
+        start = require(show, 'patch.start', minimum=1, maximum=DMX_SLOTS)
+        channels = [start + i * footprint for i in range(steps)]
+
+    used = {}
+    for step, channel in enumerate(channels, 1):
+        if not isinstance(channel, int) or channel < 1 or channel + footprint - 1 > DMX_SLOTS:
+            raise ShowError('step %d is patched outside 1..%d' % (step, DMX_SLOTS))
+        for slot in range(channel, channel + footprint):
+            if slot in used:
+                raise ShowError('steps %d and %d overlap on channel %d' % (used[slot], step, slot))
+            used[slot] = step
+
+    colours = [list(base_colour) for _ in range(steps)]
+    for key, colour in show.get('colours', {}).items():
+        if not key.isdigit() or not 1 <= int(key) <= steps:
+            raise ShowError('colours: no step "%s"' % key)
+        colours[int(key) - 1] = check_colour(colour, footprint, 'colours.%s' % key)
+
+    scenes = []
+    for name, scene in show.get('scenes', {}).items():
+        where = 'scenes.%s' % name
+        if not name.isidentifier():
+            raise ShowError('%s: scene names must be identifiers' % where)
+        fade = require(scene, 'fade_ms', minimum=0, maximum=65535, default=0)
+        cues = []
+        seen = set()
+        for cue in scene.get('cues', []):
+            if not isinstance(cue, list) or len(cue) not in (2, 3) or \
+                    not all(isinstance(v, int) and not isinstance(v, bool) for v in cue):
+                raise ShowError('%s: cues are [channel, value] or [channel, value, fade_ms]' % where)
+            channel, value, cue_fade = cue[0], cue[1], cue[2] if len(cue) == 3 else 0
+            if not 1 <= channel <= DMX_SLOTS or not 0 <= value <= 255 or not 0 <= cue_fade <= 65535:
+                raise ShowError('%s: cue %s out of range' % (where, cue))
+            if channel in seen:
+                raise ShowError('%s: channel %d listed twice' % (where, channel))
+            seen.add(channel)
+            cues.append((channel, value, cue_fade))
+        scenes.append((name, fade, cues))
+
+    slots = max(used)
+    for _, _, cues in scenes:
+        slots = max([slots] + [c[0] for c in cues])
+
+    budget = show.get('power', {}).get('budget_w', 0)
+    other = show.get('power', {}).get('other_channel_w', 0)
+    for key, value in (('budget_w', budget), ('other_channel_w', other)):
+        if not isinstance(value, (int, float)) or isinstance(value, bool) or value < 0:
+            raise ShowError('"power.%s" must be a number >= 0' % key)
+    if other > 65:
+        raise ShowError('"power.other_channel_w" must be <= 65')
+    hysteresis = require(show, 'power.hysteresis_pct', minimum=0, maximum=50, default=5)
+
+    milliwatts = [int(round(other * 1000))] * (slots + 1)
+    milliwatts[0] = 0
+    for channel in channels:
+        for c in range(footprint):
+            milliwatts[channel + c] = int(round(watts[c] * 1000))
+
+    return {
+        'name': show.get('name', ''),
+        'steps': steps,
+        'params': params,
+        'footprint': footprint,
+        'channels': channels,
+        'colours': colours,
+        'scenes': scenes,
+        'slots': slots,
+        'milliwatts': milliwatts,
+        'budget': int(round(budget * 1000)),
+        'hysteresis': hysteresis,
+    }
+
+
+def emit_header(compiled, source):
+    p = compiled['params']
+    out = []
+    w = out.append
+    w('/**')
+    w(' * Generated by tools/showc.py from %s - do not edit.' % source)
+    if compiled['name']:
+        w(' * Show: %s' % compiled['name'])
+    w(' */')
+    w('')
+    w('#ifndef SHOW_H')
+    w('#define SHOW_H')
+    w('')
+    w('#include <stdint.h>')
+    w('')
+    w('namespace show {')
+    w('')
+    w('constexpr uint8_t  numSteps       = %d;' % compiled['steps'])
+    w('constexpr uint16_t debounceDelay  = %d;' % p['debounce'])
+    w('constexpr uint16_t frameDelay     = %d;' % p['frame'])
+    w('constexpr uint16_t stepDelay      = %d;' % p['step'])
+    w('constexpr uint16_t holdDelay      = %d;' % p['hold'])
+    w('constexpr uint16_t clearStepDelay = %d;' % p['clear_step'])
+    w('constexpr uint16_t fadeInDelay    = %d;' % p['fade_in'])
+    w('constexpr uint16_t fadeOutDelay   = %d;' % p['fade_out'])
+    w('constexpr uint8_t  onLevel        = %d;' % p['level'])
+    w('constexpr uint16_t edgeWidth      = %d;   // wavefront ramp, 1/256 steps' % p['edge'])
+    w('constexpr uint8_t  tailFloor      = %d;' % p['tail_floor'])
+    w('constexpr uint16_t tailHalfLife   = %d;   // ms (0 = no tail)' % p['tail_half_life'])
+    w('')
+    w('constexpr uint16_t footprint      = %d;   // DMX channels per step' % compiled['footprint'])
+    w('constexpr uint16_t dmxSlots       = %d;   // highest patched or cued channel' % compiled['slots'])
+    w('')
+    w('// First DMX channel of each step, indexed by step - 1.')
+    w('constexpr uint16_t patch[numSteps] = {')
+    for i in range(0, compiled['steps'], 8):
+        w('  ' + ', '.join('%3d' % c for c in compiled['channels'][i:i + 8]) + ',')
+    w('};')
+    w('')
+    w('// Value of each fixture channel at full step level, indexed by step - 1.')
+    w('constexpr uint8_t colour[numSteps][footprint] = {')
+    for colour in compiled['colours']:
+        w('  {' + ', '.join('%3d' % v for v in colour) + '},')
+    w('};')
+    w('')
+    w('constexpr uint32_t powerBudget    = %d;   // mW, 0 = no limit' % compiled['budget'])
+    w('constexpr uint8_t  powerHysteresis = %d;   // percent' % compiled['hysteresis'])
+    w('')
+    w('// Draw of each DMX channel at full level in mW, indexed by channel.')
+    w('constexpr uint16_t channelMilliwatts[dmxSlots + 1] = {')
+    mw = compiled['milliwatts']
+    for i in range(0, len(mw), 8):
+        w('  ' + ', '.join('%5d' % v for v in mw[i:i + 8]) + ',')
+    w('};')
+    w('')
+    w('struct SceneCue {')
+    w('  uint16_t channel;')
+    w('  uint8_t  value;')
+    w('  uint16_t fadeMillis;   // 0 = scene default')
+    w('};')
+    w('')
+    w('struct Scene {')
+    w('  const char *name;')
+    w('  uint16_t firstCue;     // index into sceneCues')
+    w('  uint16_t cueCount;')
+    w('  uint16_t fadeMillis;')
+    w('};')
+    w('')
+    cues = [cue for _, _, scene_cues in compiled['scenes'] for cue in scene_cues]
+    w('constexpr uint16_t numSceneCues = %d;' % len(cues))
+    w('constexpr SceneCue sceneCues[%s] = {' % ('numSceneCues' if cues else '1'))
+    for channel, value, fade in cues or [(0, 0, 0)]:
+        w('  {%3d, %3d, %5d},' % (channel, value, fade))
+    w('};')
+    w('')
+    w('constexpr uint8_t numScenes = %d;' % len(compiled['scenes']))
+    w('constexpr Scene scenes[%s] = {' % ('numScenes' if compiled['scenes'] else '1'))
+    first = 0
+    for name, fade, scene_cues in compiled['scenes'] or [('', 0, [])]:
+        w('  {"%s", %d, %d, %d},' % (name, first, len(scene_cues), fade))
+        first += len(scene_cues)
+    w('};')
+    w('')
+    w('static_assert(dmxSlots <= 512, "show patch exceeds one DMX universe");')
+    w('static_assert(numSteps < 255, "step loops count to numSteps in uint8_t");')
+    w('')
+    w('}  // namespace show')
+    w('')
+    w('#endif')
+    return '\n'.join(out) + '\n'
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compile a staircase show file into a firmware header.')
+    parser.add_argument('show', help='show description (JSON)')
+    parser.add_argument('header', help='header to write, e.g. include/show.h')
+    args = parser.parse_args()
+
+    try:
+        with open(args.show) as f:
+            compiled = compile_show(json.load(f))
+    except (OSError, ValueError, ShowError) as e:
+        sys.exit('%s: %s' % (args.show, e))
+
+    with open(args.header, 'w') as f:
+        f.write(emit_header(compiled, args.show))
+    print('%s: %d steps, %d DMX slots -> %s' % (args.show, compiled['steps'], compiled['slots'], args.header))
+
+
+if __name__ == '__main__':
+    main()